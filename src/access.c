@@ -162,6 +162,10 @@ os_ioperms(u_int32_t port, int no, int v) {
 
 int
 radio_get_iopl(void) {
+#ifdef PORTIO
+	if (portio_has_access())
+		return portio_access(0, 0, 1);
+#endif /* PORTIO */
 #ifdef __FreeBSD__
 	return fbsd_get_ioperms();
 #elif defined __QNXNTO__
@@ -173,6 +177,10 @@ radio_get_iopl(void) {
 
 int
 radio_release_iopl(void) {
+#ifdef PORTIO
+	if (portio_has_access())
+		return portio_access(0, 0, 0);
+#endif /* PORTIO */
 #ifdef __FreeBSD__
 	return fbsd_release_ioperms();
 #elif defined __QNXNTO__
@@ -184,6 +192,10 @@ radio_release_iopl(void) {
 
 int
 radio_get_ioperms(u_int32_t port, int no) {
+#ifdef PORTIO
+	if (portio_has_access())
+		return portio_access(port, no, 1);
+#endif /* PORTIO */
 #ifdef __FreeBSD__
 	return fbsd_get_ioperms();
 #elif defined __QNXNTO__
@@ -195,6 +207,10 @@ radio_get_ioperms(u_int32_t port, int no) {
 
 int
 radio_release_ioperms(u_int32_t port, int no) {
+#ifdef PORTIO
+	if (portio_has_access())
+		return portio_access(port, no, 0);
+#endif /* PORTIO */
 #ifdef __FreeBSD__
 	return fbsd_release_ioperms();
 #elif defined __QNXNTO__
@@ -28,6 +28,7 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "lm700x.h"
 #include "radio_drv.h"
 
@@ -56,13 +57,18 @@ struct tuner_drv_t aztech_drv = {
 	mono_aztech, state_aztech
 };
 
-static void send_zero(void);
-static void send_one(void);
+static void set_pins(void);
 
 static int stereo = LM700X_STEREO; /* Use stereo by default */
 static int vol = 0;
 static u_int32_t radioport = 0;
 
+/* Data is bit 7, clock is bit 6, the volume bits go along */
+static struct bitbang_t bb = {
+	0, BITBANG_LSB_FIRST, 2,
+	{ 0x02, 0x40+0x02 }, { 0x80+0x02, 0x80+0x40+0x02 }, 0, 0
+};
+
 /******************************************************************/
 
 struct tuner_drv_t *
@@ -88,19 +94,18 @@ info_port_aztech(void) {
 
 void
 set_freq_aztech(u_int16_t frequency) {
-	int i;
+	struct bitbang_wave_t *w;
 	u_int32_t reg;
 
-	reg  = lm700x_encode_freq(frequency, LM700X_REF_050);
-	reg |= stereo | LM700X_REF_050 | LM700X_DIVIDER_FM;
+	if (bitbang_lookup(&bb, frequency | (stereo == LM700X_MONO) << 16,
+	    &w) == 0) {
+		reg  = lm700x_encode_freq(frequency, LM700X_REF_050);
+		reg |= stereo | LM700X_REF_050 | LM700X_DIVIDER_FM;
 
-	for (i = 0; i < LM700X_REGISTER_LENGTH; i++)
-		if (reg & (1 << i))
-			send_one();
-		else
-			send_zero();
-
-	OUTB(radioport, 0x80+0x40+vol); /* Hey, we're done */
+		bitbang_encode(&bb, w, reg, LM700X_REGISTER_LENGTH);
+		bitbang_put(w, 0x80+0x40+vol); /* Hey, we're done */
+	}
+	bitbang_emit(&bb, radioport, w);
 
 	return;
 }
@@ -129,6 +134,7 @@ set_vol_aztech(int v) {
 		break;
 	}
 
+	set_pins();
 	OUTB(radioport, vol);
 }
 
@@ -149,13 +155,10 @@ mono_aztech(void) {
 }
 
 static void
-send_zero(void) {
-	OUTB(radioport, 0x02+vol);
-	OUTB(radioport, 0x40+0x02+vol);
-}
-
-static void
-send_one(void) {
-	OUTB(radioport, 0x80+0x02+vol);
-	OUTB(radioport, 0x80+0x40+0x02+vol);
+set_pins(void) {
+	bitbang_flush(&bb);
+	bb.zero[0] = 0x02+vol;
+	bb.zero[1] = 0x40+0x02+vol;
+	bb.one[0] = 0x80+0x02+vol;
+	bb.one[1] = 0x80+0x40+0x02+vol;
 }
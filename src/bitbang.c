@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * serial bit-bang engine for the PLL chips
+ */
+
+#include <string.h>
+
+#include "ostypes.h"
+
+#include "bitbang.h"
+#include "delay.h"
+#include "radio_drv.h"
+
+struct bitbang_cache_t {
+	void *owner;
+	u_int32_t key;
+	struct bitbang_wave_t w;
+};
+
+static struct bitbang_stat_t counters;
+static struct bitbang_cache_t cache[BITBANG_CACHE_SIZE];
+
+void
+bitbang_clear(struct bitbang_wave_t *w) {
+	w->len = 0;
+}
+
+/*
+ * Append a single port value
+ */
+void
+bitbang_put(struct bitbang_wave_t *w, u_int16_t val) {
+	if (w->len < BITBANG_WAVE_MAX)
+		w->val[w->len++] = val;
+}
+
+/*
+ * Append the given number of low bits of reg
+ */
+void
+bitbang_encode(struct bitbang_t *bb, struct bitbang_wave_t *w,
+    u_int32_t reg, int bits) {
+	u_int16_t *v;
+	int i, p;
+
+	if (bits > 32)
+		bits = 32;
+	if (w->len + bits * bb->phases > BITBANG_WAVE_MAX)
+		return;
+
+	v = &w->val[w->len];
+	for (i = 0; i < bits; i++) {
+		if (reg & (1ul << (bb->order == BITBANG_MSB_FIRST ?
+		    bits - 1 - i : i)))
+			for (p = 0; p < bb->phases; p++)
+				*v++ = bb->one[p];
+		else
+			for (p = 0; p < bb->phases; p++)
+				*v++ = bb->zero[p];
+	}
+
+	w->len += bits * bb->phases;
+}
+
+void
+bitbang_emit(struct bitbang_t *bb, u_int32_t port, struct bitbang_wave_t *w) {
+	int i, r;
+
+	counters.waves++;
+	counters.writes += w->len;
+
+	if (bb->hold == 0 && bb->reads == 0) {
+		if (bb->wide)
+			for (i = 0; i < w->len; i++)
+				OUTW(port, w->val[i]);
+		else
+			for (i = 0; i < w->len; i++)
+				OUTB(port, w->val[i]);
+		return;
+	}
+
+	for (i = 0; i < w->len; i++) {
+		if (bb->wide)
+			OUTW(port, w->val[i]);
+		else
+			OUTB(port, w->val[i]);
+		for (r = 0; r < bb->reads; r++)
+			inb(port);
+		delay_usec(bb->hold);
+	}
+}
+
+/*
+ * Find the waveform cached for owner and key.
+ * Returns 1 and the cached waveform, or 0 and an empty slot claimed
+ * for them, which the caller must fill before emitting it.
+ */
+int
+bitbang_lookup(void *owner, u_int32_t key, struct bitbang_wave_t **w) {
+	struct bitbang_cache_t *c;
+	u_int32_t h;
+
+	h = key ^ (key >> 11) ^ (u_int32_t)((unsigned long)owner >> 4);
+	c = &cache[(h ^ (h >> 6)) % BITBANG_CACHE_SIZE];
+	*w = &c->w;
+
+	if (c->owner == owner && c->key == key) {
+		counters.hits++;
+		return 1;
+	}
+
+	counters.misses++;
+	c->owner = owner;
+	c->key = key;
+	bitbang_clear(&c->w);
+
+	return 0;
+}
+
+/*
+ * Forget the waveforms of owner, of all owners if NULL.
+ * Needed whenever the pins a card writes for its bits change.
+ */
+void
+bitbang_flush(void *owner) {
+	int i;
+
+	for (i = 0; i < BITBANG_CACHE_SIZE; i++)
+		if (owner == NULL || cache[i].owner == owner)
+			cache[i].owner = NULL;
+}
+
+void
+bitbang_stat(struct bitbang_stat_t *s) {
+	memcpy(s, &counters, sizeof(counters));
+}
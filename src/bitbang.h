@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * serial bit-bang engine for the PLL chips
+ *
+ * A register is first expanded into a waveform, the flat list of values
+ * written to the card port for it, then the waveform is emitted
+ * in one loop. struct bitbang_t describes the port values a card
+ * writes for a zero and for a one bit, and how long each value is held.
+ *
+ * Expanded waveforms are kept in a small cache keyed by their owner,
+ * usually the card's struct bitbang_t, and a register or frequency key,
+ * so tuning to a recently used frequency again replays the cached one.
+ */
+
+#ifndef BITBANG_H__
+#define BITBANG_H__
+
+#define BITBANG_PHASES		3
+#define BITBANG_WAVE_MAX	192
+#define BITBANG_CACHE_SIZE	64
+
+#define BITBANG_LSB_FIRST	0
+#define BITBANG_MSB_FIRST	1
+
+struct bitbang_t {
+	int wide;		/* 16-bit port writes */
+	int order;		/* BITBANG_LSB_FIRST or BITBANG_MSB_FIRST */
+	int phases;		/* Port writes per bit */
+	u_int16_t zero[BITBANG_PHASES];
+	u_int16_t one[BITBANG_PHASES];
+	u_int32_t hold;		/* Microseconds after each write */
+	int reads;		/* Dummy port reads after each write */
+};
+
+struct bitbang_wave_t {
+	int len;
+	u_int16_t val[BITBANG_WAVE_MAX];
+};
+
+struct bitbang_stat_t {
+	u_int32_t waves;
+	u_int32_t writes;
+	u_int32_t hits;		/* Waveform cache */
+	u_int32_t misses;
+};
+
+void bitbang_clear(struct bitbang_wave_t *);
+void bitbang_put(struct bitbang_wave_t *, u_int16_t);
+void bitbang_encode(struct bitbang_t *, struct bitbang_wave_t *, u_int32_t, int);
+void bitbang_emit(struct bitbang_t *, u_int32_t, struct bitbang_wave_t *);
+int bitbang_lookup(void *, u_int32_t, struct bitbang_wave_t **);
+void bitbang_flush(void *);
+void bitbang_stat(struct bitbang_stat_t *);
+
+#endif /* BITBANG_H__ */
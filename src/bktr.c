@@ -36,7 +36,7 @@
 #ifdef USE_BKTR
 #define BKTR_CAPS		DRV_INFO_KNOWS_FREQ | DRV_INFO_KNOWS_VOLU | \
 				DRV_INFO_MONOSTEREO | DRV_INFO_GETS_SIGNAL | \
-				DRV_INFO_GETS_STEREO
+				DRV_INFO_GETS_STEREO | DRV_INFO_GETS_LEVEL
 
 int get_port_bktr(u_int32_t);
 int free_port_bktr(void);
@@ -48,6 +48,7 @@ void set_vol_bktr(int);
 int get_vol_bktr(void);
 void mono_bktr(void);
 int state_bktr(void);
+int level_bktr(void);
 
 struct tuner_drv_t bktr_drv = {
 #ifdef BSDBKTR
@@ -59,7 +60,7 @@ struct tuner_drv_t bktr_drv = {
 #endif
 	get_port_bktr, free_port_bktr, info_port_bktr, find_card_bktr,
 	set_freq_bktr, get_freq_bktr, NULL,
-	set_vol_bktr, get_vol_bktr, mono_bktr, state_bktr
+	set_vol_bktr, get_vol_bktr, mono_bktr, state_bktr, level_bktr
 };
 
 static int fd = -1;
@@ -218,6 +219,31 @@ state_bktr(void) {
 #endif
 }
 
+int
+level_bktr(void) {
+#ifdef BSDBKTR
+	int ss;
+
+	if (ioctl(fd, TVTUNER_GETSTATUS, &ss) < 0) {
+		warn("TVTUNER_GETSTATUS");
+		return 0;
+	}
+
+	return (ss & 0x07) * DRV_INFO_MAX_LEVEL / 7;
+#elif defined linux
+	struct video_tuner t;
+
+	t.tuner = tuner_ord;
+
+	if (ioctl(fd, VIDIOCGTUNER, &t) < 0) {
+		warn("VIDIOCGTUNER");
+		return 0;
+	}
+
+	return (u_int32_t)t.signal * DRV_INFO_MAX_LEVEL / 0xffff;
+#endif
+}
+
 void
 mono_bktr(void) {
 #ifdef BSDBKTR
@@ -33,22 +33,44 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "bu2614.h"
+#include "delay.h"
+#include "freqtab.h"
+#include "radio.h"
 #include "radio_drv.h"
 
 u_int16_t
 bu2614_conv_freq(u_int16_t freq) {
-	return (freq + 1052)/1.2779553;
+	if (FREQTAB_IN(freq))
+		return freqtab_bu2614[FREQTAB_IDX(freq)];
+
+	return BU2614_ENCODE_FREQ(freq);
 }
 
 u_int16_t
 bu2614_unconv_freq(u_int32_t reg) {
-	return (((reg & BU2614_FREQ) * 1.2779553) - 1051);
+	return BU2614_DECODE_FREQ(reg);
 }
 
 void
 bu2614_write(struct bu2614_t *c, u_int32_t reg) {
-	u_int8_t i;
+	struct bitbang_t bb;
+	struct bitbang_wave_t *w;
+
+	/* CLOCK goes LOW then HIGH, each held for BU2614_CLOCK_DELAY */
+	bb.wide = 0;
+	bb.order = BITBANG_LSB_FIRST;
+	bb.phases = 2;
+	bb.zero[0] = c->wren;
+	bb.zero[1] = c->wren | c->clck;
+	bb.one[0] = c->wren | c->data;
+	bb.one[1] = c->wren | c->clck | c->data;
+	bb.hold = BU2614_CLOCK_DELAY;
+	bb.reads = 0;
+
+	if (bitbang_lookup(c, reg, &w) == 0)
+		bitbang_encode(&bb, w, reg, BU2614_REGISTER_LENGTH);
 
 	/*
 	 * Prepare for data transmission
@@ -59,21 +81,9 @@ bu2614_write(struct bu2614_t *c, u_int32_t reg) {
 	 */
 	OUTB(c->port, c->wren * 0 | c->clck * 1 | c->data * 1);
 	OUTB(c->port, c->wren * 1 | c->clck * 1 | c->data * 1);
-	usleep(15);
+	delay_usec(BU2614_SETUP_DELAY);
 
-	for (i = 0; i < BU2614_REGISTER_LENGTH; i++) {
-		if (reg & (1 << i)) {
-			OUTB(c->port, c->wren * 1 | c->clck * 0 | c->data * 1);
-			usleep(1);
-			OUTB(c->port, c->wren * 1 | c->clck * 1 | c->data * 1);
-			usleep(1);
-		} else {
-			OUTB(c->port, c->wren * 1 | c->clck * 0 | c->data * 0);
-			usleep(1);
-			OUTB(c->port, c->wren * 1 | c->clck * 1 | c->data * 0);
-			usleep(1);
-		}
-	}
+	bitbang_emit(&bb, c->port, w);
 
 	/* Finish transmission */
 	OUTB(c->port, c->wren * 0 | c->clck * 1 | c->data * 1);
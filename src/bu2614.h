@@ -36,9 +36,22 @@
 
 #define BU2614_REGISTER_LENGTH		32
 
+#define BU2614_SETUP_DELAY		15	/* microseconds */
+#define BU2614_CLOCK_DELAY		1	/* microseconds */
+
 #define BU2614_FREQ			0xFFFF
 #define BU2614_CONF			(0xFFFF << 16)
 
+/*
+ * The divider counts 12.78 kHz (400/313 of 10 kHz) steps above the IF.
+ * Decoding rounds up, so that the result encodes to the same register.
+ */
+#define BU2614_IF			1052
+#define BU2614_ENCODE_FREQ(f)		\
+	(((u_int32_t)(f) + BU2614_IF) * 313 / 400)
+#define BU2614_DECODE_FREQ(r)		\
+	((((u_int32_t)(r) & BU2614_FREQ) * 400 + 312) / 313 - BU2614_IF)
+
 #define BU2614_OUTPUT(x)		(x << 16)
 
 #define BU2614_CT_OFF			(0 << 23)
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * locations of the files fmio keeps between runs
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ostypes.h"
+
+#include "conf.h"
+
+/*
+ * Returns the path of file name in a static buffer, NULL if there is
+ * no place to keep it.
+ */
+char *
+conf_path(const char *name) {
+	static char path[CONF_PATHLEN];
+	char *dir;
+	int len;
+
+	if ((dir = getenv("FMIODIR")) != NULL && *dir != '\0')
+		len = snprintf(path, sizeof(path), "%s/%s", dir, name);
+	else {
+#ifdef __DOS__
+		len = snprintf(path, sizeof(path), "%s", name);
+#else
+		if ((dir = getenv("HOME")) == NULL || *dir == '\0')
+			return NULL;
+		len = snprintf(path, sizeof(path), "%s/.fmio.%s", dir, name);
+#endif /* __DOS__ */
+	}
+
+	if (len < 0 || len >= (int)sizeof(path))
+		return NULL;
+
+	return path;
+}
+
+/*
+ * Looks preset name up, vol is left alone if the preset has none.
+ * Returns -1 if there is no such preset.
+ */
+int
+conf_preset(const char *name, u_int16_t *freq, int *vol) {
+	char line[CONF_LINELEN], pname[CONF_LINELEN];
+	char *path;
+	double mhz;
+	FILE *f;
+	int n, v, ret = -1;
+
+	if ((path = conf_path("presets")) == NULL)
+		return -1;
+	if ((f = fopen(path, "r")) == NULL)
+		return -1;
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (*line == '#')
+			continue;
+		if ((n = sscanf(line, "%s %lf %d", pname, &mhz, &v)) < 2)
+			continue;
+		if (strcmp(pname, name) != 0)
+			continue;
+
+		*freq = mhz * 100 + 0.5;
+		if (n == 3)
+			*vol = v;
+		ret = 0;
+		break;
+	}
+
+	fclose(f);
+	return ret;
+}
+
+/*
+ * Port of card name if it was found no more than ttl seconds ago.
+ * Returns -1 otherwise.
+ */
+int
+conf_card_get(const char *name, u_int32_t *port, long ttl) {
+	char line[CONF_LINELEN];
+	unsigned long p, t;
+	char *path;
+	time_t now;
+	FILE *f;
+	int n, ret = -1;
+
+	if (ttl <= 0 || (path = conf_path("card")) == NULL)
+		return -1;
+	if ((f = fopen(path, "r")) == NULL)
+		return -1;
+
+	if (fgets(line, sizeof(line), f) != NULL) {
+		line[strcspn(line, "\n")] = '\0';
+		now = time(NULL);
+		if (sscanf(line, "%lx %lu %n", &p, &t, &n) >= 2 &&
+		    strcmp(line + n, name) == 0 &&
+		    (unsigned long)now >= t && now - t <= (unsigned long)ttl) {
+			*port = p;
+			ret = 0;
+		}
+	}
+
+	fclose(f);
+	return ret;
+}
+
+int
+conf_card_put(const char *name, u_int32_t port) {
+	char *path;
+	FILE *f;
+
+	if ((path = conf_path("card")) == NULL)
+		return -1;
+	if ((f = fopen(path, "w")) == NULL)
+		return -1;
+
+	fprintf(f, "0x%lx %lu %s\n", (unsigned long)port,
+	    (unsigned long)time(NULL), name);
+
+	return fclose(f) == EOF ? -1 : 0;
+}
+
+int
+conf_card_drop(void) {
+	char *path;
+
+	if ((path = conf_path("card")) == NULL)
+		return -1;
+
+	return unlink(path);
+}
+
+/*
+ * Reads no more than max entries of the last detection.
+ * Returns the number of entries, -1 if there are none.
+ */
+int
+conf_detect_load(struct conf_detect_t *d, int max) {
+	char line[CONF_LINELEN];
+	unsigned long p, s;
+	char *path;
+	FILE *f;
+	int n, found, i = 0;
+
+	if ((path = conf_path("detect")) == NULL)
+		return -1;
+	if ((f = fopen(path, "r")) == NULL)
+		return -1;
+
+	while (i < max && fgets(line, sizeof(line), f) != NULL) {
+		line[strcspn(line, "\n")] = '\0';
+		if (sscanf(line, "%lx %lx %d %n", &p, &s, &found, &n) < 3)
+			continue;
+		if (strlen(line + n) >= CONF_NAMELEN)
+			continue;
+		strcpy(d[i].name, line + n);
+		d[i].port = p;
+		d[i].sig = s;
+		d[i].found = found;
+		i++;
+	}
+
+	fclose(f);
+	return i;
+}
+
+int
+conf_detect_save(struct conf_detect_t *d, int n) {
+	char *path;
+	FILE *f;
+	int i;
+
+	if ((path = conf_path("detect")) == NULL)
+		return -1;
+	if ((f = fopen(path, "w")) == NULL)
+		return -1;
+
+	for (i = 0; i < n; i++)
+		fprintf(f, "0x%lx 0x%lx %d %s\n", (unsigned long)d[i].port,
+		    (unsigned long)d[i].sig, d[i].found, d[i].name);
+
+	return fclose(f) == EOF ? -1 : 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * locations of the files fmio keeps between runs
+ *
+ * Files live in $FMIODIR if it is set, otherwise as dot files in $HOME,
+ * under DOS in the current directory.
+ *
+ *   presets	a line per preset: name, frequency in MHz, optional volume
+ *   card	the card last found: port, time(3) it was found, card name
+ *   detect	a line per card variant -D probed: port, signature of the
+ *		hardware behind it, 1 if the card was found, card name
+ */
+
+#ifndef CONF_H__
+#define CONF_H__
+
+#define CONF_PATHLEN	1024
+#define CONF_LINELEN	256
+#define CONF_CARD_TTL	3600	/* Seconds a found card is trusted */
+#define CONF_NAMELEN	80
+#define CONF_DETECT_MAX	256
+
+struct conf_detect_t {
+	char name[CONF_NAMELEN];
+	u_int32_t port;
+	u_int32_t sig;
+	int found;
+};
+
+char *conf_path(const char *);
+int conf_preset(const char *, u_int16_t *, int *);
+int conf_card_get(const char *, u_int32_t *, long);
+int conf_card_put(const char *, u_int32_t);
+int conf_card_drop(void);
+int conf_detect_load(struct conf_detect_t *, int);
+int conf_detect_save(struct conf_detect_t *, int);
+
+#endif /* CONF_H__ */
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * short delays for bit-banged chip timing
+ *
+ * usleep() of a few microseconds costs a scheduler round trip.
+ * Delays shorter than DELAY_SLEEP_MIN spin on the monotonic timer
+ * instead.
+ * DOS has no fine timer, there each microsecond is an i/o cycle
+ * to the POST diagnostic port 0x80.
+ */
+
+#include <unistd.h>
+
+#include "ostypes.h"
+
+#ifdef __DOS__
+#include <conio.h>
+#endif /* __DOS__ */
+
+#include "delay.h"
+#include "timer.h"
+#ifdef PORTIO
+#include "portio.h"
+#endif /* PORTIO */
+
+void
+delay_usec(u_int32_t usec) {
+#ifndef __DOS__
+	u_int64_t end;
+#endif /* !__DOS__ */
+
+	if (usec == 0)
+		return;
+
+#ifdef PORTIO
+	/* Accounted and done by a simulated bus */
+	if (portio_delay(usec))
+		return;
+#endif /* PORTIO */
+
+	if (usec >= DELAY_SLEEP_MIN) {
+		usleep(usec);
+		return;
+	}
+
+#ifdef __DOS__
+	while (usec--)
+		outp(0x80, 0);
+#else
+	end = timer_usec() + usec;
+	while (timer_usec() < end)
+		;
+#endif /* __DOS__ */
+}
@@ -30,6 +30,7 @@
 #include <err.h>
 #endif
 
+#include <errno.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -51,7 +52,13 @@ typedef uint32_t u_int32_t;
 #define NOMIXER
 #endif /* __QNXNTO__ */
 
+#include "conf.h"
 #include "radio.h"
+#include "scanout.h"
+#include "station.h"
+#ifdef PORTIO
+#include "portio.h"
+#endif /* PORTIO */
 
 #include "config.h"
 
@@ -61,6 +68,7 @@ typedef uint32_t u_int32_t;
 #define SCAN	0x0100
 #define DETE	0x0200
 #define SRCH	0x0400
+#define BNCH	0x0800
 /* minor */
 #define MINOR	0x00FF
 #define STAT	0x0001
@@ -70,6 +78,7 @@ typedef uint32_t u_int32_t;
 #define INFO	0x0010
 
 char *pn = NULL;
+static struct conf_detect_t detect[CONF_DETECT_MAX];
 
 void die(int);
 void usage(void);
@@ -87,12 +96,31 @@ main(int argc, char **argv) {
 	u_int16_t action = NONE;
 	u_int16_t lower = 0, higher = 0;
 	u_int32_t cycle = 1;
+	u_int16_t step = 0;
+	int stations = 0;
+	u_int32_t iterations = 0;
+	int scanfmt = SCANOUT_TEXT;
+	char *scanfile = NULL;
+	char stationpath[CONF_PATHLEN], *stationfile = NULL;
+	char *ttl;
+	long cardttl;
+	u_int32_t cardport;
+	int cached, trusted = 0, validated = 0;
+	int detected;
+	char *sysfs = NULL;
+	FILE *out = stdout;
 #ifndef NOMIXER
 	int mixer = 0;
 	char *master_volume = NULL;
 	char *other_volume = NULL;
 #endif /* !NOMIXER */
 
+#ifndef __DOS__
+	/* A setuid fmio must not take the PCI devices from the user */
+	if (getuid() == geteuid())
+		sysfs = getenv("FMSYSFS");
+#endif
+
 	if (gouser() < 0)
 		return -1;
 
@@ -104,6 +132,11 @@ main(int argc, char **argv) {
 
 	radio_init();
 
+#ifdef PORTIO
+	if (portio_select(getenv("FMPORTIO")) < 0)
+		die(1);
+#endif /* PORTIO */
+
 	/* 
 	 * Call radio_drv_init() before usage(),
 	 * or default driver will be: NULL, 0x0
@@ -115,16 +148,36 @@ main(int argc, char **argv) {
 	if (radio_drv_init(drv) == ERADIO_INVL)
 		invalid_driver_error(drv);
 
+	if (radio_band_select(getenv("FMBAND")) < 0)
+		die(1);
+	if (radio_sprt_config(getenv("FMSPRT")) < 0)
+		die(1);
+	radio_pci_sysfs(sysfs);
+
 	if (argc < 2)
 		usage();
 
 	/* Argh... options */
 #ifndef NOMIXER
-	while ((optchar = getopt(argc, argv, "c:Dd:f:h:il:mSsv:W:X:x:")) != -1) {
+	while ((optchar = getopt(argc, argv, "a:B:b:c:Dd:F:f:h:iLl:mo:p:SsVv:W:X:x:")) != -1) {
 #else
-	while ((optchar = getopt(argc, argv, "c:Dd:f:h:il:mSsv:W:X:x:")) != -1) {
+	while ((optchar = getopt(argc, argv, "a:B:b:c:Dd:F:f:h:iLl:mo:p:SsVv:W:X:x:")) != -1) {
 #endif /* !NOMIXER */
 		switch (optchar) {
+		case 'a': /* adaptive scan, coarse step in kHz */
+			step = strtoul(optarg, (char **)NULL, 10) / 10;
+			if (step == 0)
+				step = 1;
+			action = SCAN;
+			break;
+		case 'B': /* number of benchmark iterations */
+			action = BNCH | (action & MINOR);
+			iterations = strtoul(optarg, (char **)NULL, 10);
+			break;
+		case 'b': /* band plan */
+			if (radio_band_select(optarg) < 0)
+				die(1);
+			break;
 		case 'c': /* number of probes for each scanned frequency */
 			if ((cycle = strtol(optarg, (char **)NULL, 10)) == 0)
 				cycle = 1;
@@ -137,6 +190,13 @@ main(int argc, char **argv) {
 			if (radio_drv_init(optarg) == ERADIO_INVL)
 				invalid_driver_error(optarg);
 			break;
+		case 'F': /* scan output format */
+			if ((scanfmt = scanout_format(optarg)) < 0) {
+				fprintf(stderr, "%s: unknown scan format `%s'\n",
+				    pn, optarg);
+				die(1);
+			}
+			break;
 		case 'f':
 			freq = 100.0 * strtod(optarg, (char **)NULL);
 			if (freq == 0)
@@ -149,18 +209,36 @@ main(int argc, char **argv) {
 		case 'i':
 			action |= INFO;
 			break;
+		case 'L': /* station list by hardware search */
+			stations = 1;
+			action = SCAN;
+			break;
 		case 'l':
 			lower = atof(optarg) * 100;
 			break;
 		case 'm':
 			action |= MONO;
 			break;
+		case 'o': /* scan output file */
+			scanfile = optarg;
+			break;
+		case 'p': /* tune to preset */
+			if (conf_preset(optarg, &freq, &volu) < 0) {
+				fprintf(stderr, "%s: unknown preset `%s'\n",
+				    pn, optarg);
+				die(1);
+			}
+			action |= TUNE;
+			break;
 		case 'S':
 			action = SCAN;
 			break;
 		case 's':
 			action |= STAT;
 			break;
+		case 'V': /* report probes saved */
+			radio_verbose(1);
+			break;
 		case 'v':
 			volu = strtoul(optarg, (char **)NULL, 10);
 			action |= VOLU;
@@ -182,8 +260,37 @@ main(int argc, char **argv) {
 		}
 	}
 
-	/* Minor actions have more priority */
-	if (action & MINOR) action &= MINOR;
+	/* Scan output is opened with user privileges */
+	if ((action & ~MINOR) == SCAN) {
+		if (scanfile != NULL && strcmp(scanfile, "-") != 0 &&
+		    (out = fopen(scanfile, scanfmt == SCANOUT_BINARY ?
+		    "wb" : "w")) == NULL) {
+			fprintf(stderr, "%s: %s: %s\n", pn, scanfile,
+			    strerror(errno));
+			die(1);
+		}
+		if (scanout_open(out, scanfmt) < 0) {
+			fprintf(stderr, "%s: scan output error\n", pn);
+			die(1);
+		}
+	}
+
+	/* So is the station index scans build and searches use */
+	if ((action & ~MINOR) == SCAN || (action & ~MINOR) == SRCH) {
+		/* conf_path() reuses its buffer, the card file is next */
+		if ((stationfile = conf_path("stations")) != NULL) {
+			snprintf(stationpath, sizeof(stationpath), "%s",
+			    stationfile);
+			stationfile = stationpath;
+		}
+		if (station_load(stationfile) < 0)
+			fprintf(stderr, "%s: %s: %s\n", pn, stationfile,
+			    strerror(errno));
+	}
+
+	/* Minor actions have more priority, benchmark only takes -f and -v */
+	if ((action & ~MINOR) == BNCH) action &= BNCH | TUNE | VOLU;
+	else if (action & MINOR) action &= MINOR;
 
 #if 0
 	/* Drop privs for drivers that don't need root */
@@ -192,6 +299,11 @@ main(int argc, char **argv) {
 			setuid(getuid());
 #endif
 
+	/* The card found lately is not tested again */
+	ttl = getenv("FMCARDTTL");
+	cardttl = ttl == NULL || *ttl == '\0' ? CONF_CARD_TTL : atol(ttl);
+	cached = conf_card_get(radio_info_name(), &cardport, cardttl) == 0;
+
 	/* Enabling communication with the radio port */
 	if (radio_info_root())
 		if (goroot() < 0)
@@ -201,7 +313,9 @@ main(int argc, char **argv) {
 		die(1);
 
 	/* Test for card presense */
-	if (radio_test_port() != 1) {
+	if (cached)
+		trusted = radio_trust_port(cardport);
+	if (trusted == 0 && radio_test_port() != 1) {
 		fprintf(stderr, "%s: card not found: ", pn);
 		radio_info_show(stderr, radio_info_name(), radio_info_port());
 		radio_free_port();
@@ -212,6 +326,8 @@ main(int argc, char **argv) {
 		if (gouser() < 0)
 			die(1);
 
+	validated = trusted == 0;
+
 	/*
 	 * During time consuming actions fmio can get
 	 * some signal. Define action for such emergency.
@@ -247,6 +363,20 @@ main(int argc, char **argv) {
 		}
 		if (action & TUNE)
 			radio_set_freq(freq);
+		/* A trusted card which does not take it is tested again */
+		if ((action & TUNE) && trusted && radio_check_freq() == 0) {
+			if (radio_test_port() != 1) {
+				fprintf(stderr, "%s: card not found: ", pn);
+				radio_info_show(stderr, radio_info_name(),
+				    radio_info_port());
+				if (radio_info_root())
+					gouser();
+				conf_card_drop();
+				die(1);
+			}
+			radio_set_freq(freq);
+			validated = 1;
+		}
 		if (action & VOLU)
 			radio_set_volume(volu);
 		if (action & STAT) {
@@ -274,6 +404,9 @@ main(int argc, char **argv) {
 			v = radio_info_signal();
 			if (v != ERADIO_INVL)
 				printf("Signal: %s\n", v ? "on" : "off");
+			v = radio_info_signal_level();
+			if (v != ERADIO_INVL)
+				printf("Signal level: %d%%\n", v);
 			v = radio_info_stereo();
 			if (v != ERADIO_INVL)
 				printf("Stereo: %s\n", v ? "on" : "off");
@@ -297,17 +430,28 @@ main(int argc, char **argv) {
 #endif /* !NOMIXER */
 		break;
 	case DETE:
+		if ((detected = conf_detect_load(detect, CONF_DETECT_MAX)) < 0)
+			detected = 0;
 		if (goroot() < 0)
 			die(1);
-		radio_detect();
+		detected = radio_detect(detect, detected, CONF_DETECT_MAX);
 		if (gouser() < 0)
 			die(1);
+		if (conf_detect_save(detect, detected) < 0)
+			fprintf(stderr, "%s: cannot save detected cards\n", pn);
 		break;
 	case SCAN:
 		if (radio_info_root())
 			if (goroot() < 0)
 				die(1);
-		radio_scan(lower, higher, cycle);
+		if (stations)
+			radio_stations(lower, higher, cycle);
+		else if (step)
+			radio_scan_adaptive(lower, higher, cycle, step);
+		else
+			radio_scan(lower, higher, cycle);
+		if (scanout_close() < 0)
+			fprintf(stderr, "%s: scan output error\n", pn);
 		if (radio_info_root())
 			if (gouser() < 0)
 				die(1);
@@ -333,10 +477,29 @@ main(int argc, char **argv) {
 			radio_mixer_cleanup();
 #endif /* !NOMIXER */
 		break;
+	case BNCH:
+		if (radio_info_root())
+			if (goroot() < 0)
+				die(1);
+		if ((action & VOLU) == 0)
+			volu = radio_info_policy() & 1 ? radio_info_maxvol() : 1;
+		radio_bench(freq, volu, iterations);
+		if (radio_info_root())
+			if (gouser() < 0)
+				die(1);
+		break;
 	default:
 		break;
 	}
 
+	if (validated && cardttl > 0)
+		conf_card_put(radio_info_name(), radio_info_port());
+
+	if (stationfile != NULL && station_dirty())
+		if (station_save(stationfile) < 0)
+			fprintf(stderr, "%s: %s: %s\n", pn, stationfile,
+			    strerror(errno));
+
 	if (radio_info_root())
 		if (goroot() < 0)
 			die(1);
@@ -345,6 +508,9 @@ main(int argc, char **argv) {
 		gouser();
 	radio_drv_free();
 	radio_cleanup();
+#ifdef PORTIO
+	portio_release();
+#endif /* PORTIO */
 
 	return 0;
 }
@@ -356,35 +522,51 @@ void
 usage(void) {
 	const char usage_string[] =
 #ifdef NOMIXER
-		"Usage:  %s [-d driver] [-f frequency] [-i] [-m] [-s] [-v volume]\n"
+		"Usage:  %s [-d driver] [-f frequency | -p preset] [-i] [-m] [-s]\n"
+		"\t\t[-v volume]\n"
 #else
-		"Usage:  %s [-d drv] [-f freq] [-i] [-m] [-s] [-v vol] [-X vol] [-x vol]\n"
+		"Usage:  %s [-d drv] [-f freq | -p preset] [-i] [-m] [-s] [-v vol]\n"
+		"\t\t[-X vol] [-x vol]\n"
 #endif /* NOMIXER */
-		"\t%s [-d driver] -S [-l begin] [-h end] [-c count]\n"
-		"\t%s [-d driver] -W frequency\n"
+		"\t%s [-d driver] [-b band] -S | -a step | -L [-l begin] [-h end]\n"
+		"\t\t[-c count] [-F format] [-o file] [-V]\n"
+		"\t%s [-d driver] [-b band] -W frequency\n"
+		"\t%s [-d driver] [-f frequency] [-v volume] -B iterations\n"
 		"\t%s -D - detect driver\n\n"
 
 		"\t-f frequency in Mhz, -f 98.0 for example\n"
+		"\t-p tune to preset\n"
+		"\t-b band plan: fm, ccir, us or japan\n"
 		"\t-i information\n"
 		"\t-m mono\n"
 		"\t-s stat\n"
 		"\t-v volume, -v 0 set tuner off\n"
 		"\t-S scan -l start frequency, -h end frequency\n"
+		"\t-a adaptive scan, sweep with step kHz, refine around signal\n"
+		"\t-L list stations found by the card's hardware search\n"
 		"\t-c number of probes for each scanned frequency\n"
+		"\t-F scan output format: text, csv, jsonl or binary\n"
+		"\t-o scan output file, - for stdout\n"
+		"\t-V report probes and searches to stderr\n"
 		"\t-W search\n"
+		"\t-B benchmark driver callbacks\n"
 	;
 	printf("%s version %s\n", pn, VERSION);
 	printf("Default driver: ");
 	radio_info_show(stdout, radio_info_name(), radio_info_port());
-	printf(usage_string, pn, pn, pn, pn);
+	printf(usage_string, pn, pn, pn, pn, pn);
 
 	die(0);
 }
 
 void
 die(int sig) {
+	scanout_close();
 	radio_drv_free();
 	radio_cleanup();
+#ifdef PORTIO
+	portio_release();
+#endif /* PORTIO */
 	exit(sig);
 }
 
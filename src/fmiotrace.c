@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * fmiotrace -- summarize or replay port i/o traces recorded by fmio
+ *
+ * Record with
+ *   FMPORTIO=record FMTRACE=file fmio ...
+ * which needs libradio built with -DPORTIO.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ostypes.h"
+
+#include "radio_drv.h"
+#include "portio.h"
+#include "timer.h"
+
+#ifdef PORTIO
+#define USEC()	portio_usec()
+#else
+#define USEC()	timer_usec()
+#endif /* PORTIO */
+
+struct cb_stat_t {
+	u_int32_t calls;
+	u_int32_t outs;
+	u_int32_t ins;
+	u_int32_t sleeps;
+	u_int64_t sleep_usec;
+	u_int64_t wall_usec;
+};
+
+char *pn = NULL;
+
+static struct cb_stat_t stats[PORTIO_CBS];
+static u_int32_t mismatches = 0;
+
+void usage(void);
+void account(struct portio_rec_t *, u_int32_t);
+u_int32_t replay(struct portio_rec_t *);
+void dump(struct portio_rec_t *, u_int64_t);
+void report(void);
+
+int
+main(int argc, char **argv) {
+	int optchar, dflag = 0, rflag = 0, res;
+	struct portio_rec_t rec;
+	u_int64_t now, last, t = 0;
+	FILE *f;
+
+	pn = strrchr(argv[0], '/');
+	if (pn == NULL)
+		pn = argv[0];
+	else
+		pn++;
+
+	while ((optchar = getopt(argc, argv, "dr")) != -1)
+		switch (optchar) {
+		case 'd':
+			dflag = 1;
+			break;
+		case 'r':
+			rflag = 1;
+			break;
+		default:
+			usage();
+			/* NOTREACHED */
+		}
+
+	if (optind != argc - 1)
+		usage();
+
+	if ((f = fopen(argv[optind], "rb")) == NULL) {
+		print_w("%s", argv[optind]);
+		return 1;
+	}
+
+	if (portio_trace_header(f, 0) < 0) {
+		print_wx("%s: not an fmio trace", argv[optind]);
+		return 1;
+	}
+
+	if (rflag) {
+#ifdef PORTIO
+		if (getenv("FMTRACE") != NULL) {
+			print_wx("FMTRACE must not be set when replaying");
+			return 1;
+		}
+		if (portio_select(getenv("FMPORTIO")) < 0)
+			return 1;
+#endif /* PORTIO */
+		if (radio_get_iopl() < 0)
+			return 1;
+	}
+
+	last = USEC();
+	while ((res = portio_trace_read(f, &rec)) > 0) {
+		if (rflag) {
+			rec.value = replay(&rec);
+			now = USEC();
+			rec.delta = now - last;
+			last = now;
+		}
+		t += rec.delta;
+		if (dflag)
+			dump(&rec, t);
+		account(&rec, rec.delta);
+	}
+
+	if (rflag) {
+		radio_release_iopl();
+#ifdef PORTIO
+		portio_release();
+#endif /* PORTIO */
+	}
+
+	if (res < 0)
+		print_w("%s read error", argv[optind]);
+	fclose(f);
+
+	report();
+
+	return res < 0 ? 1 : 0;
+}
+
+void
+usage(void) {
+	fprintf(stderr, "usage: %s [-dr] trace\n", pn);
+	fprintf(stderr, "  -d  dump trace records\n");
+	fprintf(stderr, "  -r  replay trace on the hardware and time it\n");
+	exit(1);
+}
+
+/*
+ * Time since the previous record belongs to the callback
+ * that was running then
+ */
+void
+account(struct portio_rec_t *rec, u_int32_t delta) {
+	static int cb = PORTIO_CB_NONE;
+
+	stats[cb].wall_usec += delta;
+
+	switch (rec->op) {
+	case PORTIO_OUTB:
+	case PORTIO_OUTW:
+	case PORTIO_OUTL:
+		stats[cb].outs++;
+		break;
+	case PORTIO_INB:
+	case PORTIO_INW:
+	case PORTIO_INL:
+		stats[cb].ins++;
+		break;
+	case PORTIO_SLEEP:
+		stats[cb].sleeps++;
+		stats[cb].sleep_usec += rec->value;
+		break;
+	case PORTIO_MARK:
+		cb = rec->port < PORTIO_CBS ? rec->port : PORTIO_CB_NONE;
+		if (cb != PORTIO_CB_NONE)
+			stats[cb].calls++;
+		break;
+	}
+}
+
+/*
+ * Repeat the access, return what the hardware answered
+ */
+u_int32_t
+replay(struct portio_rec_t *rec) {
+	u_int32_t val = rec->value;
+
+	switch (rec->op) {
+	case PORTIO_OUTB:
+		OUTB(rec->port, val);
+		break;
+	case PORTIO_OUTW:
+		OUTW(rec->port, val);
+		break;
+	case PORTIO_OUTL:
+		OUTL(rec->port, val);
+		break;
+	case PORTIO_INB:
+		val = inb(rec->port);
+		break;
+	case PORTIO_INW:
+		val = inw(rec->port);
+		break;
+	case PORTIO_INL:
+		val = inl(rec->port);
+		break;
+	case PORTIO_SLEEP:
+		usleep(val);
+		break;
+	}
+
+	if (val != rec->value)
+		mismatches++;
+
+	return val;
+}
+
+void
+dump(struct portio_rec_t *rec, u_int64_t t) {
+	printf("%10lu ", (unsigned long)t);
+
+	switch (rec->op) {
+	case PORTIO_SLEEP:
+		printf("sleep %lu\n", (unsigned long)rec->value);
+		break;
+	case PORTIO_MARK:
+		if (rec->port == PORTIO_CB_NONE)
+			printf("end 0x%x\n", rec->value);
+		else
+			printf("begin %s 0x%x\n",
+			    portio_cb_name(rec->port), rec->value);
+		break;
+	default:
+		printf("%s 0x%03x 0x%02x\n",
+		    portio_op_name(rec->op), rec->port, rec->value);
+		break;
+	}
+}
+
+void
+report(void) {
+	struct cb_stat_t *s, total;
+	int i;
+
+	memset(&total, 0, sizeof(total));
+
+	printf("%-10s %7s %8s %8s %7s %10s %10s %9s\n",
+	    "callback", "calls", "outs", "ins", "sleeps",
+	    "sleep ms", "wall ms", "us/call");
+	for (i = 0; i < PORTIO_CBS; i++) {
+		s = &stats[i];
+		if (s->calls == 0 && s->outs + s->ins + s->sleeps == 0)
+			continue;
+		printf("%-10s %7lu %8lu %8lu %7lu %10.3f %10.3f ",
+		    i == PORTIO_CB_NONE ? "(outside)" : portio_cb_name(i),
+		    (unsigned long)s->calls, (unsigned long)s->outs,
+		    (unsigned long)s->ins, (unsigned long)s->sleeps,
+		    s->sleep_usec / 1000.0, s->wall_usec / 1000.0);
+		if (s->calls)
+			printf("%9.1f\n", (double)s->wall_usec / s->calls);
+		else
+			printf("%9s\n", "-");
+		total.calls += s->calls;
+		total.outs += s->outs;
+		total.ins += s->ins;
+		total.sleeps += s->sleeps;
+		total.sleep_usec += s->sleep_usec;
+		total.wall_usec += s->wall_usec;
+	}
+	printf("%-10s %7lu %8lu %8lu %7lu %10.3f %10.3f\n", "total",
+	    (unsigned long)total.calls, (unsigned long)total.outs,
+	    (unsigned long)total.ins, (unsigned long)total.sleeps,
+	    total.sleep_usec / 1000.0, total.wall_usec / 1000.0);
+
+	if (mismatches)
+		printf("%lu reads differ from the trace\n",
+		    (unsigned long)mismatches);
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * frequency to register tables of the PLL chips
+ */
+
+#ifndef FREQTAB_H__
+#define FREQTAB_H__
+
+/*
+ * freqtab.c is generated by gentab(1) from the chips' ENCODE_FREQ macros
+ * and covers the MIN_FM_FREQ..MAX_FM_FREQ raster in 10 kHz steps
+ */
+#define FREQTAB_LEN		(MAX_FM_FREQ - MIN_FM_FREQ + 1)
+#define FREQTAB_IN(f)		((f) >= MIN_FM_FREQ && (f) <= MAX_FM_FREQ)
+#define FREQTAB_IDX(f)		((f) - MIN_FM_FREQ)
+
+#define FREQTAB_LM700X_STEP	50	/* kHz, LM700X_REF_050 */
+
+extern const u_int16_t freqtab_bu2614[];
+extern const u_int16_t freqtab_lm700x[];
+extern const u_int16_t freqtab_tea5757[];
+
+#endif /* FREQTAB_H__ */
@@ -30,6 +30,7 @@
 #include "ostypes.h"
 
 #include "bu2614.h"
+#include "delay.h"
 #include "radio_drv.h"
 
 #define GTI_CAPS	DRV_INFO_NEEDS_ROOT | DRV_INFO_GETS_SIGNAL | \
@@ -133,6 +134,6 @@ set_freq_gti(u_int16_t freq) {
 
 int
 state_gti(void) {
-	usleep(50);
+	delay_usec(50);
 	return inb(card.port) & 8 ? 0 : DRV_INFO_SIGNAL;
 }
@@ -33,6 +33,7 @@
 #include <errno.h>
 #include <stdio.h>
 
+#include "bitbang.h"
 #include "radio_drv.h"
 #include "tea5757.h"
 
@@ -58,6 +59,7 @@
 int get_port_gtp(u_int32_t);
 int free_port_gtp(void);
 u_int32_t info_port_gtp(void);
+int use_port_gtp(u_int32_t);
 int find_card_gtp(void);
 void set_freq_gtp(u_int16_t);
 u_int16_t search_gtp(int, u_int16_t);
@@ -69,20 +71,21 @@ struct tuner_drv_t gtp_drv = {
 	"Gemtek PCI", "gtp", NULL, 0, GTP_CAPS,
 	get_port_gtp, free_port_gtp, info_port_gtp, find_card_gtp,
 	set_freq_gtp, NULL, search_gtp, mute_gtp, NULL,
-	mono_gtp, state_gtp
+	mono_gtp, state_gtp,
+	NULL, NULL, use_port_gtp
 };
 
 struct tuner_drv_t mr_drv = {
 	"Guillemot MaxiRadio FM2000", "mr", NULL, 0, GTP_CAPS,
 	get_port_gtp, free_port_gtp, info_port_gtp, find_card_gtp,
 	set_freq_gtp, NULL, search_gtp, mute_gtp, NULL,
-	mono_gtp, state_gtp
+	mono_gtp, state_gtp,
+	NULL, NULL, use_port_gtp
 };
 
+static u_int32_t locate_card(void);
 static u_int32_t read_shift_register(void);
 static void write_shift_register(u_int32_t data);
-static void send_zero(void);
-static void send_one(void);
 
 static u_int32_t radioport = 0;
 static struct tea5757_t card = {
@@ -90,6 +93,19 @@ static struct tea5757_t card = {
 	read_shift_register, write_shift_register
 };
 
+static struct bitbang_t bb = {
+	1, BITBANG_MSB_FIRST, 3,
+	{
+		GTP_WREN_ON | GTP_DATA_OFF | GTP_CLCK_OFF,
+		GTP_WREN_ON | GTP_DATA_OFF | GTP_CLCK_ON,
+		GTP_WREN_ON | GTP_DATA_OFF | GTP_CLCK_OFF
+	}, {
+		GTP_WREN_ON | GTP_DATA_ON | GTP_CLCK_OFF,
+		GTP_WREN_ON | GTP_DATA_ON | GTP_CLCK_ON,
+		GTP_WREN_ON | GTP_DATA_ON | GTP_CLCK_OFF
+	}, 0, 0
+};
+
 /*********************************************************************/
 
 struct tuner_drv_t *
@@ -104,19 +120,13 @@ export_mr(void) {
 
 int
 get_port_gtp(u_int32_t port) {
+	tea5757_invalidate(&card);
 	return radio_get_iopl() < 0 ? -1 : 0;
 }
 
 int
 find_card_gtp(void) {
-	struct pci_dev_t pd = {
-		PCI_VENDOR_ID_GEMTEK, PCI_DEVICE_ID_GEMTEK_PR103,
-		PCI_SUBSYS_ID_ANY, PCI_SUBSYS_ID_ANY, PCI_SUBCLASS_ANY,
-		PCI_REVISION_ANY
-	};
-
-	radioport = pci_bus_locate(&pd);
-	if (radioport == 0) {
+	if ((radioport = locate_card()) == 0) {
 		errno = ENXIO;
 		return -1;
 	}
@@ -134,6 +144,32 @@ info_port_gtp(void) {
 	return radioport;
 }
 
+/*
+ * Port of the tuner, 0 if there is no such PCI device
+ */
+static u_int32_t
+locate_card(void) {
+	struct pci_dev_t pd = {
+		PCI_VENDOR_ID_GEMTEK, PCI_DEVICE_ID_GEMTEK_PR103,
+		PCI_SUBSYS_ID_ANY, PCI_SUBSYS_ID_ANY, PCI_SUBCLASS_ANY,
+		PCI_REVISION_ANY
+	};
+
+	return pci_bus_locate(&pd);
+}
+
+int
+use_port_gtp(u_int32_t port) {
+	/* The port comes from a file the user can write */
+	if (port == 0 || port != locate_card()) {
+		errno = ENXIO;
+		return -1;
+	}
+
+	radioport = port;
+	return 0;
+}
+
 /*
  * Set frequency and other stuff
  * Basically, this is just writing the 25-bit shift register
@@ -174,40 +210,25 @@ mono_gtp(void) {
 	card.stereo = TEA5757_MONO;
 }
 
-static void
-send_one(void) {
-	OUTW(radioport, GTP_WREN_ON | GTP_DATA_ON | GTP_CLCK_OFF);
-	OUTW(radioport, GTP_WREN_ON | GTP_DATA_ON | GTP_CLCK_ON);
-	OUTW(radioport, GTP_WREN_ON | GTP_DATA_ON | GTP_CLCK_OFF);
-}
-
-static void
-send_zero(void) {
-	OUTW(radioport, GTP_WREN_ON | GTP_DATA_OFF | GTP_CLCK_OFF);
-	OUTW(radioport, GTP_WREN_ON | GTP_DATA_OFF | GTP_CLCK_ON);
-	OUTW(radioport, GTP_WREN_ON | GTP_DATA_OFF | GTP_CLCK_OFF);
-}
-
 void
 mute_gtp(int v) {
 	/* The only way to unmute the card is to set frequency */
-	if (v == 0)
+	if (v == 0) {
 		OUTW(radioport, 0x1f);
+		tea5757_invalidate(&card);
+	}
 }
 
 static void
 write_shift_register(u_int32_t data) {
-	int c = 25;
+	struct bitbang_wave_t *w;
 
-	OUTW(radioport, 0x06);
-
-	while ( c-- )
-		if (data & (1 << c))
-			send_one();
-		else
-			send_zero();
-
-	OUTW(radioport, 0x10);
+	if (bitbang_lookup(&bb, data, &w) == 0) {
+		bitbang_put(w, 0x06);
+		bitbang_encode(&bb, w, data, 25);
+		bitbang_put(w, 0x10);
+	}
+	bitbang_emit(&bb, radioport, w);
 }
 
 static u_int32_t
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * gentab -- generate freqtab.c, the frequency to register tables
+ *
+ * Every table entry is computed from the chip's ENCODE_FREQ macro, which
+ * the drivers still use outside of the table range. Before anything is
+ * written each chip is checked over the whole raster: the decoded
+ * register must encode to the same register and lie within one register
+ * step below the frequency, exactly on it for chips counting 10 kHz.
+ *
+ *   gentab > freqtab.c	generate
+ *   gentab -v		check only
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ostypes.h"
+
+#include "bu2614.h"
+#include "freqtab.h"
+#include "lm700x.h"
+#include "radio.h"
+#include "tc921x.h"
+#include "tea5757.h"
+
+#define PER_LINE	8
+
+static int verify(const char *, u_int32_t (*)(u_int32_t),
+    u_int32_t (*)(u_int32_t), u_int32_t);
+static u_int32_t bu2614_enc(u_int32_t);
+static u_int32_t bu2614_dec(u_int32_t);
+static u_int32_t lm700x_enc(u_int32_t);
+static u_int32_t lm700x_dec(u_int32_t);
+static u_int32_t tc921x_enc(u_int32_t);
+static u_int32_t tc921x_dec(u_int32_t);
+static u_int32_t tea5757_enc(u_int32_t);
+static u_int32_t tea5757_dec(u_int32_t);
+static void table(const char *, u_int32_t (*)(u_int32_t));
+
+int
+main(int argc, char **argv) {
+	int vflag = 0, bad = 0;
+
+	if (argc == 2 && strcmp(argv[1], "-v") == 0)
+		vflag = 1;
+	else if (argc != 1) {
+		fprintf(stderr, "usage: gentab [-v]\n");
+		return 1;
+	}
+
+	/* Steps in 10 kHz units: 12.78, 5, 1 and 12.5 kHz */
+	bad += verify("bu2614", bu2614_enc, bu2614_dec, 2);
+	bad += verify("lm700x", lm700x_enc, lm700x_dec, FREQTAB_LM700X_STEP / 10);
+	bad += verify("tc921x", tc921x_enc, tc921x_dec, 1);
+	bad += verify("tea5757", tea5757_enc, tea5757_dec, 2);
+	if (bad)
+		return 1;
+	if (vflag)
+		return 0;
+
+	printf("/*\n * generated by gentab, do not edit\n */\n\n");
+	printf("#include \"ostypes.h\"\n\n");
+	printf("#include \"freqtab.h\"\n#include \"radio.h\"\n");
+
+	table("bu2614", bu2614_enc);
+	table("lm700x", lm700x_enc);
+	table("tea5757", tea5757_enc);
+
+	return ferror(stdout) ? 1 : 0;
+}
+
+/*
+ * Returns the number of frequencies which fail the round trip
+ */
+static int
+verify(const char *name, u_int32_t (*enc)(u_int32_t),
+    u_int32_t (*dec)(u_int32_t), u_int32_t step) {
+	u_int32_t f, reg, back;
+	int bad = 0;
+
+	for (f = MIN_FM_FREQ; f <= MAX_FM_FREQ; f++) {
+		reg = enc(f);
+		back = dec(reg);
+		if (reg > 0xFFFF || enc(back) != reg || back > f ||
+		    f - back >= step) {
+			fprintf(stderr, "gentab: %s: %lu encodes to 0x%lx, "
+			    "decodes to %lu\n", name, (unsigned long)f,
+			    (unsigned long)reg, (unsigned long)back);
+			bad++;
+		}
+	}
+
+	fprintf(stderr, "gentab: %s: %d of %d frequencies %s\n", name,
+	    FREQTAB_LEN - bad, FREQTAB_LEN, bad ? "round-trip" : "ok");
+
+	return bad;
+}
+
+static void
+table(const char *name, u_int32_t (*enc)(u_int32_t)) {
+	u_int32_t f;
+
+	printf("\nconst u_int16_t freqtab_%s[FREQTAB_LEN] = {", name);
+	for (f = MIN_FM_FREQ; f <= MAX_FM_FREQ; f++)
+		printf("%s0x%04lx%s",
+		    (f - MIN_FM_FREQ) % PER_LINE ? " " : "\n\t",
+		    (unsigned long)enc(f), f < MAX_FM_FREQ ? "," : "\n");
+	printf("};\n");
+}
+
+static u_int32_t
+bu2614_enc(u_int32_t f) {
+	return BU2614_ENCODE_FREQ(f);
+}
+
+static u_int32_t
+bu2614_dec(u_int32_t reg) {
+	return BU2614_DECODE_FREQ(reg);
+}
+
+static u_int32_t
+lm700x_enc(u_int32_t f) {
+	return LM700X_ENCODE_FREQ(f, FREQTAB_LM700X_STEP);
+}
+
+/* The chip is never read back, this only checks the encoding */
+static u_int32_t
+lm700x_dec(u_int32_t reg) {
+	return (reg * FREQTAB_LM700X_STEP + 9) / 10 - LM700X_IF;
+}
+
+static u_int32_t
+tc921x_enc(u_int32_t f) {
+	return TC921X_ENCODE_FREQ(f);
+}
+
+static u_int32_t
+tc921x_dec(u_int32_t reg) {
+	return TC921X_DECODE_FREQ(reg);
+}
+
+static u_int32_t
+tea5757_enc(u_int32_t f) {
+	return TEA5757_ENCODE_FREQ(f);
+}
+
+static u_int32_t
+tea5757_dec(u_int32_t reg) {
+	return TEA5757_DECODE_FREQ(reg);
+}
@@ -25,7 +25,9 @@
 
 #include "ostypes.h"
 
+#include "freqtab.h"
 #include "lm700x.h"
+#include "radio.h"
 
 u_int32_t
 lm700x_encode_ref(u_int16_t rf) {
@@ -56,11 +58,9 @@ lm700x_decode_ref(u_int32_t rf) {
 
 u_int32_t
 lm700x_encode_freq(u_int16_t f, u_int32_t rf) {
-	u_int32_t reg;
+	if (rf == LM700X_REF_050 && FREQTAB_IN(f))
+		return freqtab_lm700x[FREQTAB_IDX(f)];
 
-	reg = f + 1070; /* Add IF 10.7 MHz */
-	reg *= 10; /* Keep this, or the rf = 25 kHz will fail */
-	reg /= lm700x_decode_ref(rf); /* Static divider for bandwidth */
-
-	return reg;
+	/* Static divider for bandwidth */
+	return LM700X_ENCODE_FREQ(f, lm700x_decode_ref(rf));
 }
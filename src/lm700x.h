@@ -46,6 +46,11 @@
 #define LM700X_DIVIDER_AM	(0 << 23)	/* 0x000000 */
 #define LM700X_DIVIDER_FM	(1 << 23)	/* 0x800000 */
 
+/* Reference frequency step is given in kHz */
+#define LM700X_IF		1070	/* 10.7 MHz */
+#define LM700X_ENCODE_FREQ(f, step)	\
+	(((u_int32_t)(f) + LM700X_IF) * 10 / (step))
+
 u_int32_t lm700x_encode_ref(u_int16_t);
 u_int16_t lm700x_decode_ref(u_int32_t);
 u_int32_t lm700x_encode_freq(u_int16_t, u_int32_t);
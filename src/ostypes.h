@@ -33,6 +33,7 @@
 
 #ifdef __DOS__
 #include <stdint.h>
+typedef uint64_t	u_int64_t;
 typedef uint32_t	u_int32_t;
 typedef uint16_t	u_int16_t;
 typedef uint8_t		u_int8_t;
@@ -44,6 +45,7 @@ typedef uint8_t		u_int8_t;
 
 #ifdef __QNXNTO__
 #include <inttypes.h>
+typedef uint64_t	u_int64_t;
 typedef uint32_t	u_int32_t;
 typedef uint16_t	u_int16_t;
 typedef uint8_t		u_int8_t;
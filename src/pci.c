@@ -26,18 +26,34 @@
  * PCI autoconfiguration code
  */
 
-#include "ostypes.h"
-
-#ifdef DEBUG
+#ifdef linux
+#include <dirent.h>
+#include <stdlib.h>
+#endif /* linux */
 #include <stdio.h>
-#endif
+#include <string.h>
+
+#include "ostypes.h"
 
 #include "pci.h"
 #include "radio_drv.h"
+#include "timer.h"
 
-u_int16_t pci_base_addr(struct pci_entry_t *);
+void pci_scan_bus(int);
+#ifdef linux
+int pci_scan_sysfs(const char *);
+int pci_sysfs_read(const char *, const char *, u_int32_t *);
+#endif /* linux */
 u_int32_t pci_read_reg(struct pci_entry_t *, u_int8_t);
-int pci_device_match(struct pci_entry_t *, struct pci_dev_t *);
+int pci_device_match(struct pci_info_t *, struct pci_dev_t *);
+
+static struct pci_info_t pci_table[PCI_TABLE_MAX];
+static struct pci_stat_t pci_stat;
+static int pci_scanned = 0;
+static u_int8_t pci_visited[PCI_MAX_BUS + 1];
+#ifdef linux
+static const char *pci_sysfs_root = PCI_SYSFS;
+#endif /* linux */
 
 /*
  * PCI specification prior to 2.2 has two configuration modes.
@@ -47,36 +63,289 @@ int pci_device_match(struct pci_entry_t *, struct pci_dev_t *);
  */
 
 /*
- * Scan all PCI buses, devices and device functions until
- * required device is found. Return base address of a first entry.
+ * Where sysfs is mounted, NULL or empty - the default.
+ * Ignored where there is no sysfs.
  */
-u_int16_t
-pci_bus_locate(struct pci_dev_t *card) {
+void
+pci_sysfs(const char *root) {
+#ifdef linux
+	pci_sysfs_root = root == NULL || *root == '\0' ? PCI_SYSFS : root;
+#endif /* linux */
+}
+
+/*
+ * Read ids, class, subsystem and base addresses of every device
+ * function once, drivers look their cards up in this table.
+ * Returns the number of functions found.
+ */
+int
+pci_scan(void) {
 	struct pci_entry_t e;
-	u_int32_t data;
+	u_int64_t t;
+	int bus;
+
+	if (pci_scanned)
+		return pci_stat.devices;
+
+	t = timer_usec();
+#ifdef linux
+	if (pci_scan_sysfs(pci_sysfs_root) < 0)
+#endif /* linux */
+	{
+		pci_stat.source = "ports";
+		memset(pci_visited, 0, sizeof(pci_visited));
+		pci_scan_bus(0);
+		/* Roots of other host bridges, no PCI-PCI bridge leads there */
+		e.dev = e.fun = 0;
+		for (bus = 1; bus <= PCI_MAX_BUS; bus++) {
+			if (pci_visited[bus])
+				continue;
+			e.bus = bus;
+			pci_stat.slots++;
+			if (pci_read_reg(&e, PCI_ID_REG) != 0xFFFFFFFF)
+				pci_scan_bus(bus);
+		}
+	}
+	pci_stat.usec = timer_usec() - t;
+	pci_scanned = 1;
+
+	return pci_stat.devices;
+}
 
-	for (e.bus = 0; e.bus <= PCI_MAX_BUS; e.bus++) {
-		for (e.dev = 0; e.dev <= PCI_MAX_DEV; e.dev++) {
-			for (e.fun = 0; e.fun <= PCI_MAX_FUN; e.fun++) {
-				if (pci_device_match(&e, card)) {
-					data = pci_base_addr(&e);
-					/* We don't need mem address */
-					if (PCI_BASEADDR_IO_TYPE & data)
-						return PCI_BASEADDR(data);
+/*
+ * Functions 1-7 are looked at only on multi-function devices, and
+ * the buses behind the bridges found are walked too, so the whole
+ * 0-255 range is covered without reading every slot.
+ */
+void
+pci_scan_bus(int bus) {
+	struct pci_entry_t e;
+	struct pci_info_t *p;
+	u_int32_t id, bhlc, buses;
+	int i, bars, sec;
+
+	pci_visited[bus] = 1;
+
+	e.bus = bus;
+	for (e.dev = 0; e.dev <= PCI_MAX_DEV; e.dev++) {
+		for (e.fun = 0; e.fun <= PCI_MAX_FUN; e.fun++) {
+			pci_stat.slots++;
+			id = pci_read_reg(&e, PCI_ID_REG);
+			if (id == 0xFFFFFFFF) {
+				if (e.fun == 0) /* No such device */
+					break;
+				continue;
+			}
+			bhlc = pci_read_reg(&e, PCI_BHLC_REG);
+
+			if (pci_stat.devices < PCI_TABLE_MAX) {
+				p = &pci_table[pci_stat.devices++];
+				memset(p, 0, sizeof(*p));
+				p->loc = e;
+				p->id = id;
+				p->class = pci_read_reg(&e, PCI_CLASS_REG);
+				switch (PCI_HDRTYPE(bhlc)) {
+				case PCI_HDRTYPE_DEVICE:
+					p->subsys = pci_read_reg(&e,
+					    PCI_SUBSYSVEND_REG);
+					bars = PCI_BARS;
+					break;
+				case PCI_HDRTYPE_BRIDGE:
+					bars = 2;
+					break;
+				default:
+					bars = 0;
+					break;
 				}
+				for (i = 0; i < bars; i++)
+					p->bar[i] = pci_read_reg(&e,
+					    PCI_BASEADDR_0 + 4 * i);
+#ifdef DEBUG
+				printf("bus %u, dev %u, fun %u:", e.bus, e.dev, e.fun);
+				printf("\tvendor id 0x%x, product id 0x%x\n", PCI_VENDOR(id), PCI_PRODUCT(id));
+#endif /* DEBUG */
+			}
+
+			if (PCI_HDRTYPE(bhlc) == PCI_HDRTYPE_BRIDGE ||
+			    PCI_HDRTYPE(bhlc) == PCI_HDRTYPE_CARDBUS) {
+				buses = pci_read_reg(&e, PCI_BRIDGE_BUS_REG);
+				sec = PCI_BRIDGE_SECONDARY(buses);
+				/* Unconfigured bridges have secondary bus 0 */
+				if (sec != 0 && !pci_visited[sec] &&
+				    sec <= PCI_BRIDGE_SUBORDINATE(buses))
+					pci_scan_bus(sec);
 			}
+
+			if (e.fun == 0 && !PCI_HDRTYPE_MULTIFN(bhlc))
+				break;
 		}
 	}
+}
 
-	return 0u;
+#ifdef linux
+/*
+ * Fill the table from the devices the kernel lists under root/bus/pci,
+ * no configuration cycles and no privileges needed.
+ * Returns -1 if there is no such directory.
+ */
+int
+pci_scan_sysfs(const char *root) {
+	char path[PCI_SYSFS_PATHLEN], line[PCI_SYSFS_PATHLEN];
+	unsigned int dom, bus, dev, fun;
+	unsigned long long start, end, flags;
+	struct pci_info_t *p;
+	struct dirent *de;
+	u_int32_t v;
+	FILE *f;
+	DIR *d;
+	int i;
+
+	snprintf(path, sizeof(path), "%s/bus/pci/devices", root);
+	if ((d = opendir(path)) == NULL)
+		return -1;
+
+	pci_stat.source = "sysfs";
+	while ((de = readdir(d)) != NULL) {
+		if (sscanf(de->d_name, "%x:%x:%x.%x",
+		    &dom, &bus, &dev, &fun) != 4)
+			continue;
+		pci_stat.slots++;
+		if (pci_stat.devices == PCI_TABLE_MAX)
+			continue;
+		snprintf(path, sizeof(path), "%s/bus/pci/devices/%s",
+		    root, de->d_name);
+
+		p = &pci_table[pci_stat.devices];
+		memset(p, 0, sizeof(*p));
+		p->loc.bus = bus;
+		p->loc.dev = dev;
+		p->loc.fun = fun;
+		if (pci_sysfs_read(path, "vendor", &v) < 0)
+			continue;
+		p->id = v << PCI_VENDOR_SHIFT;
+		if (pci_sysfs_read(path, "device", &v) < 0)
+			continue;
+		p->id |= v << PCI_PRODUCT_SHIFT;
+		/* Class, subclass and interface, the register has revision too */
+		if (pci_sysfs_read(path, "class", &v) < 0)
+			continue;
+		p->class = v << 8;
+		if (pci_sysfs_read(path, "revision", &v) == 0)
+			p->class |= v & PCI_REVISION_MASK;
+		if (pci_sysfs_read(path, "subsystem_vendor", &v) == 0)
+			p->subsys = v << PCI_VENDOR_SHIFT;
+		if (pci_sysfs_read(path, "subsystem_device", &v) == 0)
+			p->subsys |= v << PCI_PRODUCT_SHIFT;
+
+		/* A line per region: start, end, flags */
+		strncat(path, "/resource", sizeof(path) - strlen(path) - 1);
+		if ((f = fopen(path, "r")) != NULL) {
+			for (i = 0; i < PCI_BARS; i++) {
+				if (fgets(line, sizeof(line), f) == NULL)
+					break;
+				if (sscanf(line, "%llx %llx %llx",
+				    &start, &end, &flags) != 3)
+					break;
+				if (flags & PCI_SYSFS_RESOURCE_IO)
+					p->bar[i] = start | PCI_BASEADDR_IO_TYPE;
+				else
+					p->bar[i] = start;
+			}
+			fclose(f);
+		}
+		pci_stat.devices++;
+	}
+
+	closedir(d);
+	return 0;
+}
+
+/*
+ * Number in the file name of the device directory.
+ */
+int
+pci_sysfs_read(const char *dir, const char *name, u_int32_t *v) {
+	char path[PCI_SYSFS_PATHLEN];
+	unsigned long l;
+	FILE *f;
+	int n;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	if ((f = fopen(path, "r")) == NULL)
+		return -1;
+	pci_stat.reads++;
+	n = fscanf(f, "%lx", &l);
+	fclose(f);
+	if (n != 1)
+		return -1;
+
+	*v = l;
+	return 0;
+}
+#endif /* linux */
+
+/*
+ * Next device after the one given (NULL - the first one) that matches
+ * card, NULL if there are no more.
+ */
+struct pci_info_t *
+pci_find(struct pci_dev_t *card, struct pci_info_t *after) {
+	struct pci_info_t *p, *end;
+
+	pci_scan();
+
+	end = pci_table + pci_stat.devices;
+	for (p = after == NULL ? pci_table : after + 1; p < end; p++)
+		if (pci_device_match(p, card))
+			return p;
+
+	return NULL;
+}
+
+void
+pci_scan_stat(struct pci_stat_t *st) {
+	*st = pci_stat;
 }
 
 /*
- * Return base address of a PCI device specified in the struct pci_entry_t
+ * Return I/O base address of a first device matching card.
  */
 u_int16_t
-pci_base_addr(struct pci_entry_t *c) {
-	return pci_read_reg(c, PCI_BASEADDR_0);
+pci_bus_locate(struct pci_dev_t *card) {
+	struct pci_info_t *p = NULL;
+
+	while ((p = pci_find(card, p)) != NULL)
+		/* We don't need mem address */
+		if (PCI_BASEADDR_IO_TYPE & p->bar[0])
+			return PCI_BASEADDR(p->bar[0]);
+
+	return 0u;
+}
+
+/*
+ * Hash of the ids and locations of all multimedia devices,
+ * it changes when such a card is added, removed or moved.
+ */
+u_int32_t
+pci_fingerprint(void) {
+	struct pci_info_t *p, *end;
+	u_int32_t hash = 2166136261u;
+
+	pci_scan();
+
+	end = pci_table + pci_stat.devices;
+	for (p = pci_table; p < end; p++) {
+		if (PCI_CLASS(p->class) != PCI_CLASS_MULTIMEDIA)
+			continue;
+		/* FNV-1a */
+		hash = (hash ^ PCI_BUS_NO(p->loc.bus) ^
+		    PCI_DEV_NO(p->loc.dev) ^ PCI_FUN_NO(p->loc.fun)) *
+		    16777619u;
+		hash = (hash ^ p->id) * 16777619u;
+		hash = (hash ^ p->subsys) * 16777619u;
+	}
+
+	return hash;
 }
 
 /*
@@ -88,6 +357,7 @@ pci_read_reg(struct pci_entry_t *c, u_int8_t reg) {
 	data  = PCI_CYCLE_ENABLE_BIT;
 	data |= PCI_BUS_NO(c->bus) | PCI_DEV_NO(c->dev) | PCI_FUN_NO(c->fun);
 	data |= PCI_REG_ADDR(reg);
+	pci_stat.reads++;
 	OUTL(CONFIG_ADDRESS, data);
 	return inl(CONFIG_DATA);
 }
@@ -100,49 +370,35 @@ pci_read_reg(struct pci_entry_t *c, u_int8_t reg) {
  * Return TRUE on match, FALSE if else.
  */
 int
-pci_device_match(struct pci_entry_t *e, struct pci_dev_t *c) {
-	u_int32_t data;
-
+pci_device_match(struct pci_info_t *p, struct pci_dev_t *c) {
 	/* These must be defined */
-	data = pci_read_reg(e, PCI_ID_REG);
-#ifdef DEBUG
-	if (data != 0xFFFFFFFF) {
-		printf("bus %u, dev %u, fun %u:", e->bus, e->dev, e->fun);
-		printf("\tvendor id 0x%x, product id 0x%x\n", PCI_VENDOR(data), PCI_PRODUCT(data));
-	}
-#endif /* DEBUG */
-
-	if (PCI_PRODUCT(data) != c->did)
+	if (PCI_PRODUCT(p->id) != c->did)
 		return 0;
-	if (PCI_VENDOR(data) != c->vid)
+	if (PCI_VENDOR(p->id) != c->vid)
 		return 0;
 
 #ifdef DEBUG
-	printf("bus %u, dev %u, fun %u:", e->bus, e->dev, e->fun);
-	printf("\tvendor id 0x%x, product id 0x%x\n", PCI_VENDOR(data), PCI_PRODUCT(data));
-	data = pci_read_reg(e, PCI_CLASS_REG);
+	printf("bus %u, dev %u, fun %u:", p->loc.bus, p->loc.dev, p->loc.fun);
+	printf("\tvendor id 0x%x, product id 0x%x\n", PCI_VENDOR(p->id), PCI_PRODUCT(p->id));
 	printf("\tclass multimedia, subclass 0x%x, revision 0x%x\n",
-			PCI_SUBCLASS(data), PCI_REVISION(data));
-	data = pci_read_reg(e, PCI_SUBSYSVEND_REG);
-	printf("\tsubsystem vendor id 0x%x, subsystem id 0x%x\n", PCI_VENDOR(data), PCI_PRODUCT(data));
+			PCI_SUBCLASS(p->class), PCI_REVISION(p->class));
+	printf("\tsubsystem vendor id 0x%x, subsystem id 0x%x\n", PCI_VENDOR(p->subsys), PCI_PRODUCT(p->subsys));
 #endif /* DEBUG */
 
-	data = pci_read_reg(e, PCI_CLASS_REG);
-	if (PCI_CLASS(data) != PCI_CLASS_MULTIMEDIA)
+	if (PCI_CLASS(p->class) != PCI_CLASS_MULTIMEDIA)
 		return 0;
 	if (c->subclass != PCI_SUBCLASS_ANY)
-		if (c->subclass != PCI_SUBCLASS(data))
+		if (c->subclass != PCI_SUBCLASS(p->class))
 			return 0;
 	if (c->rev != PCI_REVISION_ANY)
-		if (c->rev != PCI_REVISION(data))
+		if (c->rev != PCI_REVISION(p->class))
 			return 0;
 
-	data = pci_read_reg(e, PCI_SUBSYSVEND_REG);
 	if (c->subvid != PCI_SUBSYS_ID_ANY)
-		if (c->subvid != PCI_VENDOR(data))
+		if (c->subvid != PCI_VENDOR(p->subsys))
 			return 0;
 	if (c->subdid != PCI_SUBSYS_ID_ANY)
-		if (c->subdid != PCI_PRODUCT(data))
+		if (c->subdid != PCI_PRODUCT(p->subsys))
 			return 0;
 
 	return 1;
@@ -39,16 +39,7 @@
 #define PCI_FUN_NO(x)			(((x) & 7) << 8)
 #define PCI_REG_ADDR(x)			((((x) >> 2) & 0x3F) << 2)
 
-#if 0
-	/*
-	 * PCI_MAX_BUS == 0xFF requires too much time to look up a card.
-	 * Majority of the cards are on buses 0, 1 and 2, so
-	 * reduce the search time by setting PCI_MAX_BUS = 0xF.
-	 */
 #define PCI_MAX_BUS			0xFF
-#else
-#define PCI_MAX_BUS			0x0F
-#endif /* 0 */
 #define PCI_MAX_DEV			0x1F
 #define PCI_MAX_FUN			0x07
 
@@ -79,6 +70,18 @@
 #define PCI_REVISION_MASK		0xff
 #define PCI_REVISION(cr) (((cr) >> PCI_REVISION_SHIFT) & PCI_REVISION_MASK)
 
+#define PCI_HDRTYPE_SHIFT		16
+#define PCI_HDRTYPE_MASK		0x7f
+#define PCI_HDRTYPE(bhlc) (((bhlc) >> PCI_HDRTYPE_SHIFT) & PCI_HDRTYPE_MASK)
+#define PCI_HDRTYPE_MULTIFN(bhlc)	((bhlc) & (0x80 << PCI_HDRTYPE_SHIFT))
+
+#define PCI_HDRTYPE_DEVICE		0x00
+#define PCI_HDRTYPE_BRIDGE		0x01	/* PCI-PCI */
+#define PCI_HDRTYPE_CARDBUS		0x02	/* PCI-CardBus */
+
+#define PCI_BRIDGE_SECONDARY(x)		(((x) >> 8) & 0xff)
+#define PCI_BRIDGE_SUBORDINATE(x)	(((x) >> 16) & 0xff)
+
 #define PCI_BASEADDR_IO_TYPE		(1 << 0)
 #define PCI_BASEADDR_MEM_TYPE		(0 << 0)
 #define PCI_BASEADDR(x)			((x) & ~0x03)
@@ -96,6 +99,7 @@
 #define PCI_CARDBUS_CIS_REG 		0x28
 #define PCI_SUBSYSVEND_REG		0x2c
 #define PCI_CARDBUSCIS_REG		0x28
+#define PCI_BRIDGE_BUS_REG		0x18	/* Bridge headers */
 #define PCI_CAPLISTPTR_REG		0x34
 #define	PCI_INTERRUPT_REG		0x3c
 
@@ -105,4 +109,35 @@ struct pci_entry_t {
 	u_int8_t fun;
 };
 
+#define PCI_BARS			6
+#define PCI_TABLE_MAX			256
+
+/* What one enumeration pass keeps of every function found */
+struct pci_info_t {
+	struct pci_entry_t loc;
+	u_int32_t id;
+	u_int32_t class;
+	u_int32_t subsys;
+	u_int32_t bar[PCI_BARS];
+};
+
+#define PCI_SYSFS			"/sys"	/* Linux */
+#define PCI_SYSFS_PATHLEN		1024
+#define PCI_SYSFS_RESOURCE_IO		0x100
+
+struct pci_stat_t {
+	char *source;		/* "ports" or "sysfs" */
+	u_int32_t slots;	/* Functions looked at */
+	u_int32_t devices;	/* Functions found */
+	u_int32_t reads;	/* Configuration cycles or files read */
+	u_int64_t usec;
+};
+
+struct pci_dev_t;	/* radio_drv.h */
+
+void pci_sysfs(const char *);
+int pci_scan(void);
+struct pci_info_t *pci_find(struct pci_dev_t *, struct pci_info_t *);
+void pci_scan_stat(struct pci_stat_t *);
+
 #endif /* PCI_H__ */
@@ -0,0 +1,818 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * implementation of selectable port i/o backends
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ostypes.h"
+
+/* Keep OUTB()/inb() native in this file */
+#define PORTIO_IMPL
+#include "radio_drv.h"
+#include "portio.h"
+#include "timer.h"
+
+static const char *op_names[] = {
+	"outb", "outw", "outl", "inb", "inw", "inl", "sleep", "mark"
+};
+
+static const char *cb_names[PORTIO_CBS] = {
+	"none", "get_port", "free_port", "find_card", "set_freq", "get_freq",
+	"search", "set_volu", "get_volu", "set_mono", "get_state",
+	"get_level", "get_dev", "use_port", "probe"
+};
+
+#ifdef PORTIO
+
+static void native_outb(u_int32_t, u_int8_t);
+static void native_outw(u_int32_t, u_int16_t);
+static void native_outl(u_int32_t, u_int32_t);
+static u_int8_t native_inb(u_int32_t);
+static u_int16_t native_inw(u_int32_t);
+static u_int32_t native_inl(u_int32_t);
+static void native_sleep(u_int32_t);
+
+static int devport_open(const char *);
+static int devport_close(void);
+static int devport_access(u_int32_t, int, int);
+static void devport_outb(u_int32_t, u_int8_t);
+static void devport_outw(u_int32_t, u_int16_t);
+static void devport_outl(u_int32_t, u_int32_t);
+static u_int8_t devport_inb(u_int32_t);
+static u_int16_t devport_inw(u_int32_t);
+static u_int32_t devport_inl(u_int32_t);
+
+static int sim_open(const char *);
+static int sim_close(void);
+static int sim_access(u_int32_t, int, int);
+static void sim_outb(u_int32_t, u_int8_t);
+static void sim_outw(u_int32_t, u_int16_t);
+static void sim_outl(u_int32_t, u_int32_t);
+static u_int8_t sim_inb(u_int32_t);
+static u_int16_t sim_inw(u_int32_t);
+static u_int32_t sim_inl(u_int32_t);
+static void sim_sleep(u_int32_t);
+
+static int record_open(const char *);
+static int record_attach(struct portio_ops_t *, const char *);
+static int record_close(void);
+static void record_outb(u_int32_t, u_int8_t);
+static void record_outw(u_int32_t, u_int16_t);
+static void record_outl(u_int32_t, u_int32_t);
+static u_int8_t record_inb(u_int32_t);
+static u_int16_t record_inw(u_int32_t);
+static u_int32_t record_inl(u_int32_t);
+static void record_sleep(u_int32_t);
+
+static struct portio_ops_t *portio_lookup(const char *, const char **);
+static void record_log(int, u_int32_t, u_int32_t);
+
+static struct portio_ops_t native_ops = {
+	"native", 1, NULL, NULL, NULL,
+	native_outb, native_outw, native_outl,
+	native_inb, native_inw, native_inl,
+	native_sleep
+};
+
+static struct portio_ops_t devport_ops = {
+	"devport", 1, devport_open, devport_close, devport_access,
+	devport_outb, devport_outw, devport_outl,
+	devport_inb, devport_inw, devport_inl,
+	native_sleep
+};
+
+static struct portio_ops_t sim_ops = {
+	"sim", 0, sim_open, sim_close, sim_access,
+	sim_outb, sim_outw, sim_outl,
+	sim_inb, sim_inw, sim_inl,
+	sim_sleep
+};
+
+static struct portio_ops_t record_ops = {
+	"record", 0, record_open, record_close, NULL,
+	record_outb, record_outw, record_outl,
+	record_inb, record_inw, record_inl,
+	record_sleep
+};
+
+static struct portio_ops_t *backends[] = {
+	&native_ops, &devport_ops, &sim_ops, &record_ops
+};
+
+static struct portio_ops_t *bus = &native_ops;
+static struct portio_ops_t *inner = NULL;	/* Recorded backend */
+static struct portio_stat_t counters;
+
+static const char *devport = "/dev/port";
+static int devport_fd = -1;
+
+static u_int8_t sim_latch[PORTIO_SIM_PORTS];
+static int sim_readback = 0;		/* Reads return the last write */
+static struct portio_dev_t *sim_devs = NULL;
+static u_int64_t sim_slept = 0;		/* Sleeps skipped by simulation */
+
+static FILE *record_out = NULL;
+static int record_binary = 0;
+static u_int64_t record_start, record_last;
+
+/*
+ * Select backend by its spec "name[:argument]"
+ */
+int
+portio_select(const char *spec) {
+	struct portio_ops_t *ops;
+	const char *arg;
+
+	if (spec == NULL || *spec == '\0')
+		spec = native_ops.name;
+
+	if ((ops = portio_lookup(spec, &arg)) == NULL) {
+		print_wx("unknown port i/o backend `%s'", spec);
+		return -1;
+	}
+
+	portio_release();
+
+	/* A trace file implies recording */
+	if (ops != &record_ops && getenv("FMTRACE") != NULL &&
+	    *getenv("FMTRACE") != '\0') {
+		if (record_attach(ops, arg) < 0)
+			return -1;
+		ops = &record_ops;
+	} else if (ops->open != NULL)
+		if (ops->open(arg) < 0)
+			return -1;
+
+	bus = ops;
+	portio_stat_reset();
+
+	return 0;
+}
+
+int
+portio_release(void) {
+	int ret = 0;
+
+	if (bus->close != NULL)
+		ret = bus->close();
+	bus = &native_ops;
+
+	return ret;
+}
+
+char *
+portio_name(void) {
+	return bus->name;
+}
+
+int
+portio_needs_root(void) {
+	return bus->needs_root;
+}
+
+/*
+ * Whether the backend grants port access itself
+ * instead of iopl()/ioperm()
+ */
+int
+portio_has_access(void) {
+	return bus->access != NULL;
+}
+
+int
+portio_access(u_int32_t port, int no, int on) {
+	return bus->access == NULL ? 0 : bus->access(port, no, on);
+}
+
+void
+portio_outb(u_int32_t port, u_int8_t val) {
+	counters.ops[PORTIO_OUTB]++;
+	bus->outb(port, val);
+}
+
+void
+portio_outw(u_int32_t port, u_int16_t val) {
+	counters.ops[PORTIO_OUTW]++;
+	bus->outw(port, val);
+}
+
+void
+portio_outl(u_int32_t port, u_int32_t val) {
+	counters.ops[PORTIO_OUTL]++;
+	bus->outl(port, val);
+}
+
+u_int8_t
+portio_inb(u_int32_t port) {
+	counters.ops[PORTIO_INB]++;
+	return bus->inb(port);
+}
+
+u_int16_t
+portio_inw(u_int32_t port) {
+	counters.ops[PORTIO_INW]++;
+	return bus->inw(port);
+}
+
+u_int32_t
+portio_inl(u_int32_t port) {
+	counters.ops[PORTIO_INL]++;
+	return bus->inl(port);
+}
+
+void
+portio_usleep(u_int32_t usec) {
+	counters.sleeps++;
+	counters.sleep_usec += usec;
+	bus->sleep(usec);
+}
+
+/*
+ * Account a delay the caller spins itself
+ * Returns 1 if the bus is simulated and there is nothing to wait for
+ */
+int
+portio_delay(u_int32_t usec) {
+	counters.sleeps++;
+	counters.sleep_usec += usec;
+
+	if (bus == &record_ops)
+		record_log(PORTIO_SLEEP, 0, usec);
+
+	if ((bus == &record_ops ? inner : bus) != &sim_ops)
+		return 0;
+
+	sim_slept += usec;
+	return 1;
+}
+
+/*
+ * Mark entry to a driver callback (PORTIO_CB_NONE - return from it)
+ */
+void
+portio_mark(int cb, u_int32_t arg) {
+	if (bus == &record_ops)
+		record_log(PORTIO_MARK, cb, arg);
+}
+
+void
+portio_stat(struct portio_stat_t *s) {
+	memcpy(s, &counters, sizeof(counters));
+}
+
+void
+portio_stat_reset(void) {
+	memset(&counters, 0, sizeof(counters));
+}
+
+u_int32_t
+portio_stat_total(struct portio_stat_t *s) {
+	u_int32_t total = 0;
+	int i;
+
+	for (i = 0; i < PORTIO_OPS; i++)
+		total += s->ops[i];
+
+	return total;
+}
+
+int
+portio_sim_attach(struct portio_dev_t *dev) {
+	if (dev == NULL || dev->len <= 0)
+		return -1;
+
+	dev->next = sim_devs;
+	sim_devs = dev;
+
+	return 0;
+}
+
+int
+portio_sim_detach(struct portio_dev_t *dev) {
+	struct portio_dev_t **p;
+
+	for (p = &sim_devs; *p != NULL; p = &(*p)->next)
+		if (*p == dev) {
+			*p = dev->next;
+			return 0;
+		}
+
+	return -1;
+}
+
+/* INTERNAL STUFF */
+static struct portio_ops_t *
+portio_lookup(const char *spec, const char **arg) {
+	int i, len;
+	const char *colon;
+
+	colon = strchr(spec, ':');
+	len = colon == NULL ? strlen(spec) : colon - spec;
+	*arg = colon == NULL ? NULL : colon + 1;
+
+	for (i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+		if (strlen(backends[i]->name) == len &&
+		    strncasecmp(spec, backends[i]->name, len) == 0)
+			return backends[i];
+
+	return NULL;
+}
+
+/* Time as seen by the driver, simulated sleeps included */
+u_int64_t
+portio_usec(void) {
+	return timer_usec() + sim_slept;
+}
+
+/* Native backend */
+static void
+native_outb(u_int32_t port, u_int8_t val) {
+	OUTB(port, val);
+}
+
+static void
+native_outw(u_int32_t port, u_int16_t val) {
+	OUTW(port, val);
+}
+
+static void
+native_outl(u_int32_t port, u_int32_t val) {
+	OUTL(port, val);
+}
+
+static u_int8_t
+native_inb(u_int32_t port) {
+	return inb(port);
+}
+
+static u_int16_t
+native_inw(u_int32_t port) {
+	return inw(port);
+}
+
+static u_int32_t
+native_inl(u_int32_t port) {
+	return inl(port);
+}
+
+static void
+native_sleep(u_int32_t usec) {
+	usleep(usec);
+}
+
+/*
+ * /dev/port backend
+ * Every access becomes a sequence of byte-wide i/o cycles
+ */
+static int
+devport_open(const char *arg) {
+#ifdef linux
+	return 0;
+#else
+	errno = ENODEV;
+	print_w("%s backend", devport_ops.name);
+	return -1;
+#endif /* linux */
+}
+
+static int
+devport_close(void) {
+	return devport_access(0, 0, 0);
+}
+
+static int
+devport_access(u_int32_t port, int no, int on) {
+	if (on && devport_fd < 0) {
+		if ((devport_fd = open(devport, O_RDWR)) < 0) {
+			print_w("%s open error", devport);
+			return -1;
+		}
+	} else if (!on && devport_fd >= 0) {
+		close(devport_fd);
+		devport_fd = -1;
+	}
+
+	return 0;
+}
+
+static void
+devport_write(u_int32_t port, u_int32_t val, int len) {
+	u_int8_t buf[4];
+	int i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = (val >> (8 * i)) & 0xff;
+
+	if (lseek(devport_fd, port, SEEK_SET) < 0 ||
+	    write(devport_fd, buf, len) != len)
+		print_w("%s write error at 0x%x", devport, port);
+}
+
+static u_int32_t
+devport_read(u_int32_t port, int len) {
+	u_int8_t buf[4];
+	u_int32_t val = 0;
+	int i;
+
+	memset(buf, 0xff, sizeof(buf));
+	if (lseek(devport_fd, port, SEEK_SET) < 0 ||
+	    read(devport_fd, buf, len) != len)
+		print_w("%s read error at 0x%x", devport, port);
+
+	for (i = len; i--;)
+		val = (val << 8) | buf[i];
+
+	return val;
+}
+
+static void
+devport_outb(u_int32_t port, u_int8_t val) {
+	devport_write(port, val, 1);
+}
+
+static void
+devport_outw(u_int32_t port, u_int16_t val) {
+	devport_write(port, val, 2);
+}
+
+static void
+devport_outl(u_int32_t port, u_int32_t val) {
+	devport_write(port, val, 4);
+}
+
+static u_int8_t
+devport_inb(u_int32_t port) {
+	return devport_read(port, 1);
+}
+
+static u_int16_t
+devport_inw(u_int32_t port) {
+	return devport_read(port, 2);
+}
+
+static u_int32_t
+devport_inl(u_int32_t port) {
+	return devport_read(port, 4);
+}
+
+/*
+ * Simulated bus
+ * Ports claimed by an attached device model are routed to it.
+ * Any other port floats high like an empty ISA slot, or,
+ * with "sim:latch", reads back the last value written to it.
+ */
+static int
+sim_open(const char *arg) {
+	memset(sim_latch, 0xff, sizeof(sim_latch));
+	sim_readback = arg != NULL && strcasecmp(arg, "latch") == 0;
+	return 0;
+}
+
+static int
+sim_close(void) {
+	return 0;
+}
+
+static int
+sim_access(u_int32_t port, int no, int on) {
+	return 0;
+}
+
+static struct portio_dev_t *
+sim_device(u_int32_t port) {
+	struct portio_dev_t *dev;
+
+	for (dev = sim_devs; dev != NULL; dev = dev->next)
+		if (port >= dev->base && port < dev->base + dev->len)
+			return dev;
+
+	return NULL;
+}
+
+static void
+sim_write(u_int32_t port, u_int32_t val, int op, int len) {
+	struct portio_dev_t *dev;
+	int i;
+
+	if ((dev = sim_device(port)) != NULL) {
+		if (dev->write != NULL)
+			dev->write(port - dev->base, val, op);
+		return;
+	}
+
+	for (i = 0; i < len; i++, val >>= 8)
+		sim_latch[(port + i) % PORTIO_SIM_PORTS] = val & 0xff;
+}
+
+static u_int32_t
+sim_read(u_int32_t port, int op, int len) {
+	struct portio_dev_t *dev;
+	u_int32_t val = 0;
+	int i;
+
+	if ((dev = sim_device(port)) != NULL)
+		return dev->read == NULL ? 0xFFFFFFFFul : dev->read(port - dev->base, op);
+
+	if (sim_readback == 0)
+		return 0xFFFFFFFFul;
+
+	for (i = len; i--;)
+		val = (val << 8) | sim_latch[(port + i) % PORTIO_SIM_PORTS];
+
+	return val;
+}
+
+static void
+sim_outb(u_int32_t port, u_int8_t val) {
+	sim_write(port, val, PORTIO_OUTB, 1);
+}
+
+static void
+sim_outw(u_int32_t port, u_int16_t val) {
+	sim_write(port, val, PORTIO_OUTW, 2);
+}
+
+static void
+sim_outl(u_int32_t port, u_int32_t val) {
+	sim_write(port, val, PORTIO_OUTL, 4);
+}
+
+static u_int8_t
+sim_inb(u_int32_t port) {
+	return sim_read(port, PORTIO_INB, 1) & 0xff;
+}
+
+static u_int16_t
+sim_inw(u_int32_t port) {
+	return sim_read(port, PORTIO_INW, 2) & 0xffff;
+}
+
+static u_int32_t
+sim_inl(u_int32_t port) {
+	return sim_read(port, PORTIO_INL, 4);
+}
+
+/* Nothing to settle, the time is only accounted */
+static void
+sim_sleep(u_int32_t usec) {
+	sim_slept += usec;
+}
+
+/*
+ * Recording backend
+ * Writes a binary trace to $FMTRACE or a text log to $FMPORTLOG
+ * (stderr by default) and passes accesses to the backend named
+ * after the colon
+ */
+static int
+record_open(const char *arg) {
+	struct portio_ops_t *ops;
+	const char *inner_arg = NULL;
+
+	ops = arg == NULL ? &native_ops : portio_lookup(arg, &inner_arg);
+	if (ops == NULL || ops == &record_ops) {
+		print_wx("invalid recorded backend `%s'", arg);
+		return -1;
+	}
+
+	return record_attach(ops, inner_arg);
+}
+
+static int
+record_attach(struct portio_ops_t *ops, const char *arg) {
+	char *log;
+
+	if (ops->open != NULL)
+		if (ops->open(arg) < 0)
+			return -1;
+
+	record_binary = 0;
+	if ((log = getenv("FMTRACE")) != NULL && *log != '\0')
+		record_binary = 1;
+	else
+		log = getenv("FMPORTLOG");
+
+	if (log == NULL || *log == '\0')
+		record_out = stderr;
+	else if ((record_out = fopen(log, record_binary ? "wb" : "w")) == NULL ||
+	    (record_binary && portio_trace_header(record_out, 1) < 0)) {
+		print_w("%s open error", log);
+		if (record_out != NULL)
+			fclose(record_out);
+		record_out = NULL;
+		if (ops->close != NULL)
+			ops->close();
+		return -1;
+	}
+
+	record_start = record_last = portio_usec();
+
+	/* Port access and privileges are those of the recorded backend */
+	record_ops.needs_root = ops->needs_root;
+	record_ops.access = ops->access;
+	inner = ops;
+
+	return 0;
+}
+
+static int
+record_close(void) {
+	int ret = 0;
+
+	if (inner != NULL && inner->close != NULL)
+		ret = inner->close();
+	inner = NULL;
+
+	if (record_out != NULL && record_out != stderr)
+		fclose(record_out);
+	record_out = NULL;
+
+	return ret;
+}
+
+static void
+record_log(int op, u_int32_t port, u_int32_t val) {
+	struct portio_rec_t rec;
+	u_int64_t now = portio_usec();
+
+	if (record_binary) {
+		rec.op = op;
+		rec.port = port;
+		rec.value = val;
+		rec.delta = now - record_last;
+		record_last = now;
+		portio_trace_write(record_out, &rec);
+		return;
+	}
+
+	fprintf(record_out, "%10lu ", (unsigned long)(now - record_start));
+	switch (op) {
+	case PORTIO_SLEEP:
+		fprintf(record_out, "sleep %lu\n", (unsigned long)val);
+		break;
+	case PORTIO_MARK:
+		if (port == PORTIO_CB_NONE)
+			fprintf(record_out, "end 0x%x\n", val);
+		else
+			fprintf(record_out, "begin %s 0x%x\n",
+			    portio_cb_name(port), val);
+		break;
+	default:
+		fprintf(record_out, "%s 0x%03x 0x%02x\n",
+		    op_names[op], port, val);
+		break;
+	}
+}
+
+static void
+record_outb(u_int32_t port, u_int8_t val) {
+	record_log(PORTIO_OUTB, port, val);
+	inner->outb(port, val);
+}
+
+static void
+record_outw(u_int32_t port, u_int16_t val) {
+	record_log(PORTIO_OUTW, port, val);
+	inner->outw(port, val);
+}
+
+static void
+record_outl(u_int32_t port, u_int32_t val) {
+	record_log(PORTIO_OUTL, port, val);
+	inner->outl(port, val);
+}
+
+static u_int8_t
+record_inb(u_int32_t port) {
+	u_int8_t val = inner->inb(port);
+
+	record_log(PORTIO_INB, port, val);
+	return val;
+}
+
+static u_int16_t
+record_inw(u_int32_t port) {
+	u_int16_t val = inner->inw(port);
+
+	record_log(PORTIO_INW, port, val);
+	return val;
+}
+
+static u_int32_t
+record_inl(u_int32_t port) {
+	u_int32_t val = inner->inl(port);
+
+	record_log(PORTIO_INL, port, val);
+	return val;
+}
+
+static void
+record_sleep(u_int32_t usec) {
+	record_log(PORTIO_SLEEP, 0, usec);
+	inner->sleep(usec);
+}
+
+#endif /* PORTIO */
+
+/*
+ * Trace encoding, also used by fmiotrace without PORTIO
+ */
+char *
+portio_op_name(int op) {
+	if (op < 0 || op >= sizeof(op_names) / sizeof(op_names[0]))
+		return "?";
+	return (char *)op_names[op];
+}
+
+char *
+portio_cb_name(int cb) {
+	if (cb < 0 || cb >= PORTIO_CBS)
+		return "?";
+	return (char *)cb_names[cb];
+}
+
+/*
+ * Write (wr != 0) or check the trace magic
+ */
+int
+portio_trace_header(FILE *f, int wr) {
+	char magic[PORTIO_TRACE_MAGICLEN];
+
+	if (wr)
+		return fwrite(PORTIO_TRACE_MAGIC, PORTIO_TRACE_MAGICLEN, 1, f)
+		    == 1 ? 0 : -1;
+
+	if (fread(magic, PORTIO_TRACE_MAGICLEN, 1, f) != 1 ||
+	    memcmp(magic, PORTIO_TRACE_MAGIC, PORTIO_TRACE_MAGICLEN) != 0)
+		return -1;
+
+	return 0;
+}
+
+int
+portio_trace_write(FILE *f, struct portio_rec_t *rec) {
+	u_int8_t buf[PORTIO_TRACE_RECLEN];
+	int i;
+
+	buf[0] = rec->op;
+	buf[1] = 0;
+	buf[2] = rec->port & 0xff;
+	buf[3] = rec->port >> 8;
+	for (i = 0; i < 4; i++) {
+		buf[4 + i] = (rec->value >> (8 * i)) & 0xff;
+		buf[8 + i] = (rec->delta >> (8 * i)) & 0xff;
+	}
+
+	return fwrite(buf, sizeof(buf), 1, f) == 1 ? 0 : -1;
+}
+
+/*
+ * Returns 1 if a record was read, 0 at end of trace
+ */
+int
+portio_trace_read(FILE *f, struct portio_rec_t *rec) {
+	u_int8_t buf[PORTIO_TRACE_RECLEN];
+	int i;
+
+	if (fread(buf, sizeof(buf), 1, f) != 1)
+		return ferror(f) ? -1 : 0;
+
+	rec->op = buf[0];
+	rec->port = buf[2] | (buf[3] << 8);
+	rec->value = rec->delta = 0;
+	for (i = 4; i--;) {
+		rec->value = (rec->value << 8) | buf[4 + i];
+		rec->delta = (rec->delta << 8) | buf[8 + i];
+	}
+
+	return 1;
+}
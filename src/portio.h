@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * selectable port i/o backends
+ *
+ * Without PORTIO defined OUTB()/inb() and friends expand to the native
+ * inline instructions and nothing here is used.  With PORTIO defined
+ * every port access goes through the backend selected by portio_select():
+ *
+ *   native		inline in/out instructions (default)
+ *   devport		read/write /dev/port (Linux)
+ *   sim		in-process simulated bus, no hardware touched
+ *   record[:backend]	log every access, then pass it to backend
+ *
+ * The recorder writes a text log to $FMPORTLOG, or, if $FMTRACE is set,
+ * a binary trace of port accesses, sleeps and driver callback marks
+ * which fmiotrace(1) summarizes and replays.
+ */
+
+#ifndef PORTIO_H__
+#define PORTIO_H__
+
+#include <stdio.h>
+
+#define PORTIO_OUTB	0
+#define PORTIO_OUTW	1
+#define PORTIO_OUTL	2
+#define PORTIO_INB	3
+#define PORTIO_INW	4
+#define PORTIO_INL	5
+#define PORTIO_OPS	6
+#define PORTIO_SLEEP	6	/* Trace records only */
+#define PORTIO_MARK	7
+
+/* Driver callbacks as marked in traces */
+#define PORTIO_CB_NONE		0	/* Callback returned */
+#define PORTIO_CB_GET_PORT	1
+#define PORTIO_CB_FREE_PORT	2
+#define PORTIO_CB_FIND_CARD	3
+#define PORTIO_CB_SET_FREQ	4
+#define PORTIO_CB_GET_FREQ	5
+#define PORTIO_CB_SEARCH	6
+#define PORTIO_CB_SET_VOLU	7
+#define PORTIO_CB_GET_VOLU	8
+#define PORTIO_CB_SET_MONO	9
+#define PORTIO_CB_GET_STATE	10
+#define PORTIO_CB_GET_LEVEL	11
+#define PORTIO_CB_GET_DEV	12
+#define PORTIO_CB_USE_PORT	13
+#define PORTIO_CB_PROBE		14
+#define PORTIO_CBS		15
+
+/*
+ * Binary trace: magic, then little-endian 12-byte records
+ *   op:8 reserved:8 port:16 value:32 delta:32
+ * For PORTIO_SLEEP value is the sleep in microseconds,
+ * for PORTIO_MARK port is the callback and value its argument.
+ * delta is the time in microseconds since the previous record.
+ */
+#define PORTIO_TRACE_MAGIC	"FMIOTRC1"
+#define PORTIO_TRACE_MAGICLEN	8
+#define PORTIO_TRACE_RECLEN	12
+
+#define PORTIO_SIM_PORTS	0x10000
+
+struct portio_ops_t {
+	char *name;
+	int needs_root;			/* Opening backend requires root */
+
+	int (*open)(const char *);	/* Backend argument */
+	int (*close)(void);
+	int (*access)(u_int32_t, int, int); /* NULL - use OS permissions */
+
+	void (*outb)(u_int32_t, u_int8_t);
+	void (*outw)(u_int32_t, u_int16_t);
+	void (*outl)(u_int32_t, u_int32_t);
+	u_int8_t (*inb)(u_int32_t);
+	u_int16_t (*inw)(u_int32_t);
+	u_int32_t (*inl)(u_int32_t);
+
+	void (*sleep)(u_int32_t);	/* Microseconds */
+};
+
+/* Device model hooked into the simulated bus */
+struct portio_dev_t {
+	u_int32_t base;
+	int len;
+	void (*write)(u_int32_t, u_int32_t, int);	/* offset, value, op */
+	u_int32_t (*read)(u_int32_t, int);		/* offset, op */
+	struct portio_dev_t *next;
+};
+
+struct portio_stat_t {
+	u_int32_t ops[PORTIO_OPS];
+	u_int32_t sleeps;
+	u_int32_t sleep_usec;
+};
+
+struct portio_rec_t {
+	u_int8_t op;
+	u_int16_t port;
+	u_int32_t value;
+	u_int32_t delta;
+};
+
+int portio_select(const char *);
+int portio_release(void);
+char *portio_name(void);
+int portio_needs_root(void);
+int portio_has_access(void);
+int portio_access(u_int32_t, int, int);
+
+void portio_outb(u_int32_t, u_int8_t);
+void portio_outw(u_int32_t, u_int16_t);
+void portio_outl(u_int32_t, u_int32_t);
+u_int8_t portio_inb(u_int32_t);
+u_int16_t portio_inw(u_int32_t);
+u_int32_t portio_inl(u_int32_t);
+void portio_usleep(u_int32_t);
+int portio_delay(u_int32_t);
+void portio_mark(int, u_int32_t);
+u_int64_t portio_usec(void);
+
+void portio_stat(struct portio_stat_t *);
+void portio_stat_reset(void);
+u_int32_t portio_stat_total(struct portio_stat_t *);
+
+int portio_sim_attach(struct portio_dev_t *);
+int portio_sim_detach(struct portio_dev_t *);
+
+char *portio_op_name(int);
+char *portio_cb_name(int);
+int portio_trace_header(FILE *, int);
+int portio_trace_write(FILE *, struct portio_rec_t *);
+int portio_trace_read(FILE *, struct portio_rec_t *);
+
+#endif /* PORTIO_H__ */
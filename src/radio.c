@@ -41,10 +41,38 @@
 #include "mixer.h"
 #endif /* !NOMIXER */
 #include "radio.h"
+#include "bitbang.h"
+#include "conf.h"
+#include "pci.h"
 #include "radio_drv.h"
+#include "scanout.h"
+#include "sprt.h"
+#include "station.h"
+#include "timer.h"
 
 #define MMAX(a,b)	((a) >= (b) ? (a) : (b))
 
+/* Benchmarked callbacks */
+#define BENCH_SET_FREQ	0
+#define BENCH_GET_FREQ	1
+#define BENCH_GET_STATE	2
+#define BENCH_SET_VOLU	3
+#define BENCH_SEARCH	4
+#define BENCH_CBS	5
+
+/* Station list by chained hardware search */
+#define STATIONS_GUARD		10	/* Next search starts 100 kHz up */
+#define STATIONS_MAX_DUPS	3	/* Give up after so many relocks */
+#define STATIONS_MAX_SEEKS	256
+
+#ifdef PORTIO
+#define MARK(cb, arg)	portio_mark(cb, arg)
+#define USEC()		portio_usec()
+#else
+#define MARK(cb, arg)
+#define USEC()		timer_usec()
+#endif /* PORTIO */
+
 EXPORT_FUNC export_db[] = {
 	export_aztech,		/* Aztech/PackardBell */
 #ifdef USE_BKTR
@@ -78,19 +106,74 @@ EXPORT_FUNC export_db[] = {
 	export_zx		/* Zoltrix RadioPlus */
 };
 
+/*
+ * Band plans.  Until one is selected the first is used for scan and
+ * search limits, but tuned frequencies are passed to the driver as is.
+ * No driver tunes outside MIN_FM_FREQ..MAX_FM_FREQ, so the Japanese
+ * band is cut at 87.5 MHz and there is no OIRT plan.
+ */
+struct band_t band_db[] = {
+	{ "fm",		MIN_FM_FREQ, MAX_FM_FREQ, 1 },	/* 10 kHz steps */
+	{ "ccir",	8750, 10800, 10 },	/* 100 kHz */
+	{ "us",		8790, 10790, 20 },	/* 200 kHz, odd channels */
+	{ "japan",	MIN_FM_FREQ, 9000, 10 }	/* 100 kHz */
+};
+#define BANDS	(sizeof(band_db) / sizeof(band_db[0]))
+
 struct tuner_drv_t **drv_db;
 
 extern char *pn;
 static int driver = ERADIO_INVL;
 static int variant = ERADIO_INVL;
 static int complain = 1;
+static u_int16_t tuned = 0;
+static struct band_t *band = NULL;
+static struct sprt_t sprt;
+static int use_sprt = 1;
+static int verbose = 0;
+
+/* Run of channels with signal, see index_track() */
+static u_int16_t run_first, run_last, run_prev;
+static u_int32_t run_max = 0;
 
 int check_drv(struct tuner_drv_t *, char *);
 int test_port(struct tuner_drv_t *, u_int32_t);
+int probe_port(struct tuner_drv_t *, u_int32_t);
+int sig_port(struct tuner_drv_t *, u_int32_t, u_int32_t *);
 void draw_stick(int);
 void range(u_int16_t, u_int16_t *, u_int16_t *, u_int16_t);
+u_int16_t band_top(struct band_t *);
+u_int16_t band_ceil(struct band_t *, u_int16_t);
+u_int32_t band_range(struct band_t *, u_int16_t *, u_int16_t *);
+int bench_cmp(const void *, const void *);
+int bench_has(struct tuner_drv_t *, int);
+void bench_call(struct tuner_drv_t *, int, u_int16_t, int, u_int32_t);
+int scan_check(struct tuner_drv_t *);
+void scan_probe(struct tuner_drv_t *, u_int16_t, u_int32_t,
+    struct scan_rec_t *);
+int search_probe(struct tuner_drv_t *, u_int16_t);
+int search_verify(struct tuner_drv_t *, u_int16_t);
+void index_track(struct scan_rec_t *);
+void index_flush(void);
 u_int16_t search_up_generic(struct tuner_drv_t *, u_int16_t);
 u_int16_t search_down_generic(struct tuner_drv_t *, u_int16_t);
+u_int16_t search_level_generic(struct tuner_drv_t *, int, u_int16_t);
+u_int16_t search_afc(struct tuner_drv_t *, int, u_int16_t, u_int16_t);
+
+int call_get_port(struct tuner_drv_t *, u_int32_t);
+int call_free_port(struct tuner_drv_t *);
+int call_find_card(struct tuner_drv_t *);
+void call_set_freq(struct tuner_drv_t *, u_int16_t);
+u_int16_t call_get_freq(struct tuner_drv_t *);
+u_int16_t call_search(struct tuner_drv_t *, int, u_int16_t);
+void call_set_volu(struct tuner_drv_t *, int);
+int call_get_volu(struct tuner_drv_t *);
+void call_set_mono(struct tuner_drv_t *);
+int call_get_state(struct tuner_drv_t *);
+int call_get_level(struct tuner_drv_t *);
+int call_get_dev(struct tuner_drv_t *);
+int call_use_port(struct tuner_drv_t *, u_int32_t);
+int call_probe(struct tuner_drv_t *);
 
 /*
  * Create driver database
@@ -106,6 +189,8 @@ radio_init(void) {
 	/* Initialize the driver database */
 	for (i = 0; i < drivers; i++)
 		drv_db[i] = export_db[i]();
+
+	sprt_init(&sprt, NULL, SEARCH_PROBE);
 }
 
 int
@@ -148,12 +233,12 @@ radio_get_port(void) {
 
 	port = drv->ports == NULL ? 0 : drv->ports[variant];
 
-	return drv->get_port(port);
+	return call_get_port(drv, port);
 }
 
 int
 radio_free_port(void) {
-	return driver == ERADIO_INVL ? 0 : drv_db[driver]->free_port();
+	return driver == ERADIO_INVL ? 0 : call_free_port(drv_db[driver]);
 }
 
 int
@@ -164,21 +249,143 @@ radio_test_port(void) {
 	if (drv_db[driver]->find_card == NULL)
 		return 1;
 
-	return drv_db[driver]->find_card() == 0 ? 1 : 0;
+	return call_find_card(drv_db[driver]) == 0 ? 1 : 0;
+}
+
+/*
+ * Take the card found before at port as present without find_card.
+ * Returns 0 if the driver can't be told where the card is,
+ * radio_test_port() must be used then.
+ */
+int
+radio_trust_port(u_int32_t port) {
+	struct tuner_drv_t *drv;
+
+	if (driver == ERADIO_INVL)
+		return 0;
+	drv = drv_db[driver];
+
+	if (drv->find_card == NULL)
+		return 1;
+	if (drv->ports != NULL)
+		return drv->ports[variant] == port;
+	if (drv->use_port != NULL)
+		return call_use_port(drv, port) == 0;
+
+	return 0;
 }
 
 void
 radio_set_freq(u_int16_t freq) {
+	if (band != NULL)
+		freq = radio_band_snap(freq);
+
 	if (driver != ERADIO_INVL)
-		if (drv_db[driver]->set_freq != NULL)
-			drv_db[driver]->set_freq(freq);
+		if (drv_db[driver]->set_freq != NULL) {
+			call_set_freq(drv_db[driver], freq);
+			tuned = freq;
+		}
+}
+
+/*
+ * Returns 0 if the card reports another frequency than it was
+ * set to last, 1 if it matches or the card can't tell.
+ */
+int
+radio_check_freq(void) {
+	u_int16_t f = radio_info_freq();
+
+	return tuned == 0 || f == 0 || f == tuned;
+}
+
+/*
+ * NULL or empty name keeps the current band plan
+ */
+int
+radio_band_select(const char *name) {
+	u_int32_t i;
+
+	if (name == NULL || *name == '\0')
+		return 0;
+
+	for (i = 0; i < BANDS; i++)
+		if (strcasecmp(name, band_db[i].name) == 0) {
+			band = &band_db[i];
+			return 0;
+		}
+
+	print_wx("Unknown band plan `%s'", name);
+	return -1;
+}
+
+/*
+ * Report what scans and searches cost to stderr
+ */
+void
+radio_verbose(int on) {
+	verbose = on;
+}
+
+/*
+ * Sampling of generic search: "off" takes SEARCH_PROBE samples
+ * of every channel, otherwise SPRT parameters, see sprt.h.
+ * NULL or empty conf keeps the current setting.
+ */
+int
+radio_sprt_config(const char *conf) {
+	if (conf == NULL || *conf == '\0')
+		return 0;
+
+	if (strcasecmp(conf, "off") == 0) {
+		use_sprt = 0;
+		return 0;
+	}
+
+	if (sprt_init(&sprt, conf, SEARCH_PROBE) < 0) {
+		print_wx("Invalid SPRT parameters `%s'", conf);
+		return -1;
+	}
+	use_sprt = 1;
+
+	return 0;
+}
+
+/*
+ * Root of the sysfs tree PCI cards are looked up in (Linux),
+ * NULL for /sys.
+ */
+void
+radio_pci_sysfs(const char *root) {
+	pci_sysfs(root);
+}
+
+struct band_t *
+radio_band(void) {
+	return band == NULL ? &band_db[0] : band;
+}
+
+/*
+ * Nearest channel of the band plan
+ */
+u_int16_t
+radio_band_snap(u_int16_t freq) {
+	struct band_t *b = radio_band();
+	u_int16_t top = band_top(b);
+
+	if (freq <= b->min)
+		return b->min;
+	if (freq >= top)
+		return top;
+
+	return b->min + (freq - b->min + b->spacing / 2) / b->spacing *
+	    b->spacing;
 }
 
 void
 radio_set_volume(int vol) {
 	if (driver != ERADIO_INVL)
 		if (drv_db[driver]->set_volu != NULL)
-			drv_db[driver]->set_volu(vol);
+			call_set_volu(drv_db[driver], vol);
 }
 
 void
@@ -187,7 +394,7 @@ radio_set_mono(void) {
 		return;
 
 	if (drv_db[driver]->set_mono != NULL)
-		drv_db[driver]->set_mono();
+		call_set_mono(drv_db[driver]);
 }
 
 int
@@ -196,7 +403,7 @@ radio_info_volume(void) {
 		return ERADIO_INVL;
 
 	return drv_db[driver]->get_volu == NULL ?
-		 0 : drv_db[driver]->get_volu();
+		 0 : call_get_volu(drv_db[driver]);
 }
 
 int
@@ -208,7 +415,7 @@ radio_info_signal(void) {
 
 	if (drv_db[driver]->caps & DRV_INFO_GETS_SIGNAL)
 		if (drv_db[driver]->get_state != NULL)
-			ret = drv_db[driver]->get_state() & DRV_INFO_SIGNAL ?
+			ret = call_get_state(drv_db[driver]) & DRV_INFO_SIGNAL ?
 				1 : 0;
 
 	return ret;
@@ -223,17 +430,38 @@ radio_info_stereo(void) {
 
 	if (drv_db[driver]->caps & DRV_INFO_GETS_STEREO)
 		if (drv_db[driver]->get_state != NULL)
-			ret = drv_db[driver]->get_state() & DRV_INFO_STEREO ?
+			ret = call_get_state(drv_db[driver]) & DRV_INFO_STEREO ?
 				1 : 0;
 
 	return ret;
 }
 
+/*
+ * Signal level, 0..DRV_INFO_MAX_LEVEL
+ */
+int
+radio_info_signal_level(void) {
+	if (driver == ERADIO_INVL)
+		return ERADIO_INVL;
+
+	if (drv_db[driver]->caps & DRV_INFO_GETS_LEVEL)
+		if (drv_db[driver]->get_signal_level != NULL)
+			return call_get_level(drv_db[driver]);
+
+	return ERADIO_INVL;
+}
+
 int
 radio_info_root(void) {
 	if (driver == ERADIO_INVL)
 		return ERADIO_INVL;
 
+#ifdef PORTIO
+	/* Simulated bus needs no privileges */
+	if (portio_needs_root() == 0)
+		return 0;
+#endif /* PORTIO */
+
 	return drv_db[driver]->caps & DRV_INFO_NEEDS_ROOT ? 1 : 0;
 }
 
@@ -252,7 +480,7 @@ radio_info_freq(void) {
 		return ERADIO_INVL;
 
 	return drv_db[driver]->get_freq == NULL ?
-		0ul : drv_db[driver]->get_freq();
+		0ul : call_get_freq(drv_db[driver]);
 }
 
 char *
@@ -293,77 +521,406 @@ radio_info_show(FILE *out, char *name, u_int32_t port) {
 	fprintf(out, "\n");
 }
 
-void
-radio_detect(void) {
-	int i, vars, drivers;
+/*
+ * Cards behind a port with the same signature as in the cached
+ * detection are reported from the cache, the rest are probed.
+ * cache is replaced with the results, returns their number.
+ */
+int
+radio_detect(struct conf_detect_t *cache, int cached, int max) {
+	int i, j, vars, drivers, n, found, skipped = 0, hits = 0;
+	static struct conf_detect_t cur[CONF_DETECT_MAX];
+	struct pci_stat_t pst;
 	struct tuner_drv_t *drv;
 	u_int32_t port;
 
 	puts("Probing ports, please wait...");
 
 	drivers = sizeof(export_db) / sizeof(export_db[0]);
+	if (max > CONF_DETECT_MAX)
+		max = CONF_DETECT_MAX;
+
+	/* Take all signatures before any probe changes the hardware */
+	for (i = 0, n = 0; i < drivers; i++) {
+		drv = drv_db[i];
+		vars = drv->ports == NULL ? 1 : drv->portsno;
+		while (vars-- && n < max) {
+			port = drv->ports == NULL ? 0 : drv->ports[vars];
+			strncpy(cur[n].name, drv->name, CONF_NAMELEN - 1);
+			cur[n].name[CONF_NAMELEN - 1] = '\0';
+			cur[n].port = port;
+			cur[n].found = -1;
+			cur[n].sig = 0xffffffff; /* No port reads that */
+			if (sig_port(drv, port, &cur[n].sig) == 0)
+				for (j = 0; j < cached; j++)
+					if (cache[j].port == port &&
+					    cache[j].sig == cur[n].sig &&
+					    strcmp(cache[j].name,
+					    cur[n].name) == 0) {
+						/* Idle cards read like no card */
+						if (drv->ports != NULL &&
+						    cur[n].sig == 0xff)
+							break;
+						cur[n].found = cache[j].found;
+						hits++;
+						break;
+					}
+			n++;
+		}
+	}
 
 	complain = 0;
-	for (i = 0; i < drivers; i++) {
+	for (i = 0, j = 0; i < drivers; i++) {
 		drv = drv_db[i];
 		vars = drv->ports == NULL ? 1 : drv->portsno;
 		while (vars--) {
 			port = drv->ports == NULL ? 0 : drv->ports[vars];
-			if (test_port(drv, port)) /* Card found */
+			found = j < n ? cur[j].found : -1;
+			if (found < 0) {
+				/* Sweep unless the driver rules the card out */
+				if (probe_port(drv, port) == 0) {
+					found = 0;
+					skipped++;
+				} else
+					found = test_port(drv, port);
+				if (j < n)
+					cur[j].found = found;
+			}
+			if (found) /* Card found */
 				radio_info_show(stdout, drv->name, port);
+			j++;
 		}
 	}
 	complain = 1;
 
-	puts("done.");
+	printf("done, %d empty ports skipped, %d cached.\n", skipped, hits);
+
+	pci_scan_stat(&pst);
+	if (pst.slots)
+		printf("PCI (%s): %u devices in %u slots, %u reads, "
+		    "%lu usec\n", pst.source, pst.devices, pst.slots, pst.reads,
+		    (unsigned long)pst.usec);
+
+	memcpy(cache, cur, n * sizeof(cur[0]));
+	return n;
 }
 
 void
 radio_scan(u_int16_t s, u_int16_t e, u_int32_t cycle) {
+	struct band_t *b = radio_band();
+	struct scan_rec_t rec;
 	u_int16_t ff;
-	int signal = 0;
-	u_int32_t i;
 
 	if (driver == ERADIO_INVL)
 		return;
+	if (scan_check(drv_db[driver]) < 0)
+		return;
 
-	if ((drv_db[driver]->caps & DRV_INFO_GETS_SIGNAL) == 0 &&
-			(drv_db[driver]->caps & DRV_INFO_GETS_STEREO) == 0) {
-		print_wx("This driver does not detect signal state");
+	band_range(b, &s, &e);
+	station_clear(s, e);
+
+	for (ff = s; ff < e; ff += b->spacing) {
+		scan_probe(drv_db[driver], ff, cycle, &rec);
+		index_track(&rec);
+		if (scanout_write(&rec) < 0) {
+			print_w("scan output");
+			break;
+		}
+	}
+	index_flush();
+}
+
+/*
+ * Sweep with the given step first, then probe every channel
+ * within a step of those which showed any signal.
+ * Output is the same as of radio_scan() minus channels skipped.
+ */
+void
+radio_scan_adaptive(u_int16_t s, u_int16_t e, u_int32_t cycle,
+    u_int16_t step) {
+	struct band_t *b = radio_band();
+	struct scan_rec_t *recs;
+	u_int32_t i, lo, hi, n, probed = 0;
+
+	if (driver == ERADIO_INVL)
+		return;
+	if (scan_check(drv_db[driver]) < 0)
+		return;
+
+	if ((n = band_range(b, &s, &e)) == 0)
+		return;
+	station_clear(s, e);
+	/* Step in channels of the band plan */
+	if ((step /= b->spacing) == 0)
+		step = 1;
+	if (cycle == 0)
+		cycle = 1;
+
+	if ((recs = calloc(n, sizeof(struct scan_rec_t))) == NULL) {
+		print_w("scan");
+		return;
+	}
+
+	/* Coarse pass */
+	for (i = 0; i < n; i += step) {
+		scan_probe(drv_db[driver], s + i * b->spacing, cycle, &recs[i]);
+		probed++;
+	}
+
+	/* Fine pass, samples is zero for channels not probed yet */
+	for (i = 0; i < n; i += step) {
+		if (recs[i].state == 0)
+			continue;
+		lo = i > step ? i - step + 1 : 0;
+		hi = n - i > step ? i + step : n;
+		for (; lo < hi; lo++)
+			if (recs[lo].samples == 0) {
+				scan_probe(drv_db[driver], s + lo * b->spacing,
+				    cycle, &recs[lo]);
+				probed++;
+			}
+	}
+
+	for (i = 0; i < n; i++) {
+		if (recs[i].samples == 0)
+			continue;
+		index_track(&recs[i]);
+		if (scanout_write(&recs[i]) < 0) {
+			print_w("scan output");
+			break;
+		}
+	}
+	index_flush();
+
+	if (verbose)
+		fprintf(stderr, "%s: %lu of %lu channels probed, "
+		    "%lu probes saved\n", pn, (unsigned long)probed,
+		    (unsigned long)n, (unsigned long)(n - probed) * cycle);
+
+	free(recs);
+}
+
+/*
+ * Let the chip search up from s again and again, each time from just
+ * above the last lock point, and report every lock with its state.
+ * A lock on the last station again moves the start further up.
+ * Stops at e, when the search wraps around to the band bottom or keeps
+ * locking to the same station.
+ */
+void
+radio_stations(u_int16_t s, u_int16_t e, u_int32_t cycle) {
+	struct tuner_drv_t *drv;
+	struct scan_rec_t rec;
+	u_int16_t from, f, last = 0;
+	u_int32_t seeks = 0, found = 0, dups = 0, relocks = 0;
+	u_int64_t t;
+
+	if (driver == ERADIO_INVL)
+		return;
+	drv = drv_db[driver];
+
+	if (drv->search == NULL) {
+		print_wx("Driver does not support hardware search");
 		return;
 	}
-	if (drv_db[driver]->set_freq == NULL || drv_db[driver]->get_state == NULL)
+	if (scan_check(drv) < 0)
 		return;
 
-	range(MIN_FM_FREQ, &s, &e, MAX_FM_FREQ);
+	band_range(radio_band(), &s, &e);
+	station_clear(s, e);
+
+	for (from = s; from < e && seeks < STATIONS_MAX_SEEKS; ) {
+		t = USEC();
+		f = call_search(drv, 1, from);
+		seeks++;
+
+		/* Nothing up to the deadline, go on above it */
+		if (f == DRV_SEARCH_TIMEOUT) {
+			from += STATIONS_GUARD;
+			continue;
+		}
+		if (f == 0) {
+			print_wx("Driver does not report found frequency");
+			break;
+		}
+		f = radio_band_snap(f);
+		/* Decoding may put a lock one step either side of where it was */
+		if (last && f + 1 >= last && f <= last + 1) {
+			dups++;
+			if (++relocks >= STATIONS_MAX_DUPS)
+				break;
+			from += STATIONS_GUARD;
+			continue;
+		}
+		/* Wrapped around the band top */
+		if (f < s || (last && f < last))
+			break;
+		if (f >= e)
+			break;
 
-	if (e == MIN_FM_FREQ)
-		e = MAX_FM_FREQ;
+		scan_probe(drv, f, cycle, &rec);
+		rec.usec = USEC() - t;
 
-	for (ff = s; ff < e; ff++) {
-		signal = 0;
-		drv_db[driver]->set_freq(ff);
-		for (i = 0; i < cycle; i++)
-			signal += drv_db[driver]->get_state();
-		printf("%.2f => %d\n", (float)ff/100, signal);
+		station_add(f, rec.samples ? rec.state * 100 / rec.samples : 0);
+		if (scanout_write(&rec) < 0) {
+			print_w("scan output");
+			return;
+		}
+		found++;
+		relocks = 0;
+		last = f;
+		from = f + STATIONS_GUARD;
 	}
+
+	if (verbose)
+		fprintf(stderr, "%s: %lu stations, %lu searches, "
+		    "%lu duplicate locks\n", pn, (unsigned long)found,
+		    (unsigned long)seeks, (unsigned long)dups);
 }
 
 u_int16_t
 radio_search(int dir, u_int16_t freq) {
+	struct sprt_stat_t st0, st1;
+	u_int32_t runs;
+	u_int16_t f;
+
 	if (driver == ERADIO_INVL)
 		return 0u;
 
-	if (drv_db[driver]->search == NULL) {
-		if (drv_db[driver]->get_state == NULL)
-			print_wx("Driver does not support search");
-		else if (dir)
-			return search_up_generic(drv_db[driver], freq);
-		else
-			return search_down_generic(drv_db[driver], freq);
-	} else return drv_db[driver]->search(dir, freq);
+	/* Nearest known station, if it is still there */
+	if (station_find(dir, freq, &f) == 0) {
+		if (search_verify(drv_db[driver], f)) {
+			station_hit(f);
+			return f;
+		}
+		station_miss(f);
+	}
+
+	if (drv_db[driver]->search != NULL) {
+		f = call_search(drv_db[driver], dir, freq);
+		return f == DRV_SEARCH_TIMEOUT ? 0u : f;
+	}
+
+	if (drv_db[driver]->get_signal_level != NULL)
+		return search_level_generic(drv_db[driver], dir, freq);
+
+	if (drv_db[driver]->get_state == NULL) {
+		print_wx("Driver does not support search");
+		return 0u;
+	}
+
+	sprt_stat(&st0);
+	if (dir)
+		freq = search_up_generic(drv_db[driver], freq);
+	else
+		freq = search_down_generic(drv_db[driver], freq);
+	sprt_stat(&st1);
+
+	if (verbose && (runs = st1.runs - st0.runs) != 0)
+		fprintf(stderr, "%s: %lu channels, %lu samples, "
+		    "%lu samples saved\n", pn, (unsigned long)runs,
+		    (unsigned long)(st1.samples - st0.samples),
+		    (unsigned long)(runs * SEARCH_PROBE -
+		    (st1.samples - st0.samples)));
+
+	return freq;
+}
+
+/*
+ * Time each driver callback over the given number of iterations
+ */
+void
+radio_bench(u_int16_t freq, int vol, u_int32_t iterations) {
+	const char *names[BENCH_CBS] = {
+		"set_freq", "get_freq", "get_state", "set_volu", "search"
+	};
+	struct tuner_drv_t *drv;
+	struct band_t *b;
+	struct bitbang_stat_t bb0, bb1;
+	u_int32_t *usec, i, scan_usec = 0;
+	u_int64_t t;
+	int cb;
+#ifdef PORTIO
+	struct portio_stat_t st0, st1;
+	u_int32_t ops, sleep_usec;
+#endif /* PORTIO */
+
+	if (driver == ERADIO_INVL)
+		return;
+	drv = drv_db[driver];
+
+	if (iterations == 0)
+		iterations = 1;
+	if ((usec = malloc(iterations * sizeof(u_int32_t))) == NULL) {
+		print_w("benchmark");
+		return;
+	}
+
+	range(MIN_FM_FREQ, &freq, &freq, MAX_FM_FREQ);
+
+	printf("Driver: ");
+	radio_info_show(stdout, drv->name, radio_info_port());
+	printf("%lu iterations at %.2f MHz\n",
+	    (unsigned long)iterations, (float)freq / 100);
+	printf("%-10s %10s %10s %10s %9s %11s\n", "callback",
+	    "min us", "median us", "p99 us", "ops/call", "sleep us");
+
+	bitbang_stat(&bb0);
+
+	for (cb = 0; cb < BENCH_CBS; cb++) {
+		if (bench_has(drv, cb) == 0)
+			continue;
+
+		call_set_freq(drv, freq);
+#ifdef PORTIO
+		ops = sleep_usec = 0;
+#endif /* PORTIO */
+		for (i = 0; i < iterations; i++) {
+#ifdef PORTIO
+			portio_stat(&st0);
+#endif /* PORTIO */
+			t = USEC();
+			bench_call(drv, cb, freq, vol, i);
+			usec[i] = USEC() - t;
+#ifdef PORTIO
+			portio_stat(&st1);
+			ops += portio_stat_total(&st1) - portio_stat_total(&st0);
+			sleep_usec += st1.sleep_usec - st0.sleep_usec;
+#endif /* PORTIO */
+			if (cb == BENCH_SEARCH)
+				call_set_freq(drv, freq);
+		}
+
+		qsort(usec, iterations, sizeof(u_int32_t), bench_cmp);
+		printf("%-10s %10lu %10lu %10lu ", names[cb],
+		    (unsigned long)usec[0],
+		    (unsigned long)usec[iterations / 2],
+		    (unsigned long)usec[(iterations * 99 - 1) / 100]);
+#ifdef PORTIO
+		printf("%9.1f %11.0f\n", (float)ops / iterations,
+		    (float)sleep_usec / iterations);
+#else
+		printf("%9s %11s\n", "-", "-");
+#endif /* PORTIO */
+
+		if (cb == BENCH_SET_FREQ || cb == BENCH_GET_STATE)
+			scan_usec += usec[iterations / 2];
+	}
+
+	call_set_freq(drv, freq);
+	free(usec);
 
-	return 0u;
+	bitbang_stat(&bb1);
+	if (bb1.hits + bb1.misses != bb0.hits + bb0.misses)
+		printf("Waveform cache: %lu hits, %lu misses\n",
+		    (unsigned long)(bb1.hits - bb0.hits),
+		    (unsigned long)(bb1.misses - bb0.misses));
+
+	b = radio_band();
+	if (drv->set_freq != NULL && drv->get_state != NULL)
+		printf("Full band scan, one probe per channel: %.1f s\n",
+		    (float)scan_usec * ((band_top(b) - b->min) / b->spacing + 1) /
+		    1000000);
 }
 
 /* MIXER STUFF */
@@ -405,27 +962,80 @@ test_port(struct tuner_drv_t *drv, u_int32_t port) {
 		return 0;
 
 	if (drv->get_port)
-		if (drv->get_port(port) < 0)
+		if (call_get_port(drv, port) < 0)
 			return 0;
 
 	if (drv->find_card) {
-		res = drv->find_card();
+		res = call_find_card(drv);
 		draw_stick(c++);
 	} else if (drv->caps & DRV_INFO_NEEDS_SCAN)
 		if ((drv->caps & DRV_INFO_GETS_SIGNAL) || (drv->caps & DRV_INFO_GETS_STEREO))
 			while ((i > MIN_FM_FREQ) && (res < 10)) {
-				drv->set_freq(i);
-				res += drv->get_state();
+				call_set_freq(drv, i);
+				res += call_get_state(drv);
 				i -= 10;
 				draw_stick(c++);
 			}
 
 	if (drv->free_port)
-		drv->free_port();
+		call_free_port(drv);
 
 	return res < 0 ? 0 : 1;
 }
 
+/*
+ * Read-only signature of the hardware behind the port: what the ISA port
+ * reads, the PCI fingerprint for PCI cards.  Returns -1 with no access.
+ */
+int
+sig_port(struct tuner_drv_t *drv, u_int32_t port, u_int32_t *sig) {
+	static u_int32_t pcisig;
+	static int pcidone;
+
+	if (drv->get_port)
+		if (call_get_port(drv, port) < 0)
+			return -1;
+
+	if (drv->ports != NULL)
+		*sig = inb(port);
+	else {
+		/* The same for all PCI cards */
+		if (!pcidone)
+			pcisig = pci_fingerprint();
+		pcidone = 1;
+		*sig = pcisig;
+	}
+
+	if (drv->free_port)
+		call_free_port(drv);
+
+	return 0;
+}
+
+/*
+ * Read-only check before the frequency sweep of test_port().
+ * Returns 0 only if the driver's probe rules the card out, an idle card
+ * may read like an empty bus, so there is no generic check.
+ */
+int
+probe_port(struct tuner_drv_t *drv, u_int32_t port) {
+	int res;
+
+	if ((drv->caps & DRV_INFO_NEEDS_SCAN) == 0 || drv->probe == NULL)
+		return 1;
+
+	if (drv->get_port)
+		if (call_get_port(drv, port) < 0)
+			return 0;
+
+	res = call_probe(drv);
+
+	if (drv->free_port)
+		call_free_port(drv);
+
+	return res != 0;
+}
+
 int
 check_drv(struct tuner_drv_t *drv, char *name) {
 	int drvlen, namelen, i;
@@ -499,6 +1109,58 @@ draw_stick(int count) {
 	write(1, "\r", 1);
 }
 
+int
+bench_cmp(const void *a, const void *b) {
+	u_int32_t x = *(const u_int32_t *)a, y = *(const u_int32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+int
+bench_has(struct tuner_drv_t *drv, int cb) {
+	switch (cb) {
+	case BENCH_SET_FREQ:
+		return drv->set_freq != NULL;
+	case BENCH_GET_FREQ:
+		return drv->get_freq != NULL;
+	case BENCH_GET_STATE:
+		return drv->get_state != NULL;
+	case BENCH_SET_VOLU:
+		return drv->set_volu != NULL;
+	case BENCH_SEARCH:
+		return drv->search != NULL;
+	}
+
+	return 0;
+}
+
+/*
+ * set_freq alternates between two channels so the tuner really retunes
+ */
+void
+bench_call(struct tuner_drv_t *drv, int cb, u_int16_t freq, int vol,
+    u_int32_t i) {
+	u_int16_t alt = freq + 10 > MAX_FM_FREQ ? freq - 10 : freq + 10;
+
+	switch (cb) {
+	case BENCH_SET_FREQ:
+		call_set_freq(drv, i & 1 ? alt : freq);
+		break;
+	case BENCH_GET_FREQ:
+		call_get_freq(drv);
+		break;
+	case BENCH_GET_STATE:
+		call_get_state(drv);
+		break;
+	case BENCH_SET_VOLU:
+		call_set_volu(drv, vol);
+		break;
+	case BENCH_SEARCH:
+		call_search(drv, 1, freq);
+		break;
+	}
+}
+
 void
 range(u_int16_t lf, u_int16_t *lpf, u_int16_t *hpf, u_int16_t hf) {
 	/* forcing into range */
@@ -518,23 +1180,61 @@ range(u_int16_t lf, u_int16_t *lpf, u_int16_t *hpf, u_int16_t hf) {
 	return;
 }
 
+/*
+ * Last channel of the band plan
+ */
+u_int16_t
+band_top(struct band_t *b) {
+	return b->min + (b->max - b->min) / b->spacing * b->spacing;
+}
+
+/*
+ * First channel at or above freq
+ */
+u_int16_t
+band_ceil(struct band_t *b, u_int16_t freq) {
+	if (freq <= b->min)
+		return b->min;
+
+	return b->min + (freq - b->min + b->spacing - 1) / b->spacing *
+	    b->spacing;
+}
+
+/*
+ * Forces scan range [s, e) into the band plan, e defaults to just
+ * above its last channel, s is moved up onto the raster.
+ * Returns the number of channels in the range.
+ */
+u_int32_t
+band_range(struct band_t *b, u_int16_t *s, u_int16_t *e) {
+	u_int16_t top = band_top(b) + 1;
+
+	range(b->min, s, e, top);
+
+	if (*e == b->min)
+		*e = top;
+	*s = band_ceil(b, *s);
+
+	return *s < *e ? (*e - *s + b->spacing - 1) / b->spacing : 0;
+}
+
 u_int16_t
 search_down_generic(struct tuner_drv_t *drv, u_int16_t freq) {
+	struct band_t *b = radio_band();
+	u_int16_t top = band_top(b);
 	int max = 0;
 	int platoe_start = 0;
 	int platoe_count = 0;
 	u_int16_t f = freq;
 
-	freq++;
-
-	while (freq > MIN_FM_FREQ) {
-		int c = SEARCH_PROBE;
-		int s = 0;
+	/* Start at the first channel at or below freq */
+	freq = band_ceil(b, (freq > top ? top : freq) + 1);
 
-		drv->set_freq(--freq);
+	while (freq > b->min) {
+		int s;
 
-		while (c--)
-			s += drv->get_state();
+		freq -= b->spacing;
+		s = search_probe(drv, freq);
 
 		/* FIXME: more precise approximation */
 		if (s > max) {
@@ -545,8 +1245,8 @@ search_down_generic(struct tuner_drv_t *drv, u_int16_t freq) {
 				platoe_count++;
 		} else if (s < max) {
 			if (platoe_start) {
-				if (platoe_count > SEARCH_LENGTH) {
-					freq += platoe_count / 3;
+				if (platoe_count * b->spacing > SEARCH_LENGTH) {
+					freq += platoe_count / 3 * b->spacing;
 					break;
 				}
 			} else {
@@ -557,32 +1257,231 @@ search_down_generic(struct tuner_drv_t *drv, u_int16_t freq) {
 		}
 	}
 
-	if (freq > MIN_FM_FREQ) {
-		drv->set_freq(freq);
+	if (freq > b->min) {
+		call_set_freq(drv, freq);
 		return freq;
 	}
 
-	drv->set_freq(f);
+	call_set_freq(drv, f);
 	return f;
 }
 
+/*
+ * Step through the channels from freq on and stop past the first
+ * signal level peak of at least SEARCH_LEVEL.  Tunes to the middle
+ * of the peak, or right away where AFC puts a station with such
+ * a level, back to freq if there is none.
+ */
+u_int16_t
+search_level_generic(struct tuner_drv_t *drv, int dir, u_int16_t freq) {
+	struct band_t *b = radio_band();
+	u_int16_t top = band_top(b);
+	u_int16_t f, first = 0, last = 0;
+	int c, l, max = -1;
+
+	if (dir)
+		f = band_ceil(b, freq + 1);
+	else
+		f = band_ceil(b, freq > top ? top + 1 : freq) - b->spacing;
+
+	for (; f >= b->min && f <= top;
+	    dir ? (f += b->spacing) : (f -= b->spacing)) {
+		call_set_freq(drv, f);
+		for (l = 0, c = 0; c < SEARCH_LEVEL_PROBE; c++)
+			l += call_get_level(drv);
+		l /= SEARCH_LEVEL_PROBE;
+
+		/* AFC tells where the station is, no need for the peak */
+		if (l >= SEARCH_LEVEL && (drv->caps & DRV_INFO_GETS_AFC) &&
+		    drv->get_deviation != NULL) {
+			if ((c = search_afc(drv, dir, freq, f)) != 0)
+				return c;
+			continue;
+		}
+
+		if (l > max) {
+			max = l;
+			first = last = f;
+		} else if (l == max)
+			last = f;
+		else if (max >= SEARCH_LEVEL) {
+			f = radio_band_snap((first + last) / 2);
+			call_set_freq(drv, f);
+			return f;
+		} else {
+			max = l;
+			first = last = f;
+		}
+	}
+
+	call_set_freq(drv, freq);
+	return freq;
+}
+
+/*
+ * Tune to a known station, returns 0 if a single probe finds no signal
+ * there.  Stations are trusted by drivers which can't tell.
+ */
+int
+search_verify(struct tuner_drv_t *drv, u_int16_t freq) {
+	if (drv->set_freq == NULL)
+		return 0;
+
+	call_set_freq(drv, freq);
+
+	if (drv->get_state != NULL && (drv->caps &
+	    (DRV_INFO_GETS_SIGNAL | DRV_INFO_GETS_STEREO)))
+		return call_get_state(drv) != 0;
+	if (drv->get_signal_level != NULL)
+		return call_get_level(drv) >= SEARCH_LEVEL;
+
+	return 1;
+}
+
+/*
+ * Every run of neighbouring channels with signal adds the middle
+ * of its strongest part to the station index
+ */
+void
+index_track(struct scan_rec_t *rec) {
+	u_int32_t strength;
+
+	strength = rec->samples ? rec->state * 100 / rec->samples : 0;
+
+	if (run_max && (strength == 0 ||
+	    rec->freq > run_prev + radio_band()->spacing))
+		index_flush();
+	run_prev = rec->freq;
+
+	if (strength > run_max) {
+		run_max = strength;
+		run_first = run_last = rec->freq;
+	} else if (strength && strength == run_max)
+		run_last = rec->freq;
+}
+
+void
+index_flush(void) {
+	if (run_max)
+		station_add(radio_band_snap((run_first + run_last) / 2),
+		    run_max);
+	run_max = 0;
+}
+
+/*
+ * Let the card's AFC pull freq onto the station centre, at most
+ * SEARCH_AFC_STEPS corrections.  Returns the centre if it lies past
+ * from in the search direction, 0 if the search should go on.
+ */
+u_int16_t
+search_afc(struct tuner_drv_t *drv, int dir, u_int16_t from,
+    u_int16_t freq) {
+	u_int16_t f = freq;
+	int i, dev;
+
+	for (i = 0; i < SEARCH_AFC_STEPS; i++) {
+		dev = call_get_dev(drv);
+		f = radio_band_snap(freq + (dev + (dev < 0 ? -5 : 5)) / 10);
+		if (f == freq)
+			break;
+		freq = f;
+		call_set_freq(drv, freq);
+	}
+
+	if (dir ? f > from : f < from)
+		return f;
+
+	return 0;
+}
+
+/*
+ * Returns -1 if the driver can't scan
+ */
+int
+scan_check(struct tuner_drv_t *drv) {
+	if ((drv->caps & DRV_INFO_GETS_SIGNAL) == 0 &&
+			(drv->caps & DRV_INFO_GETS_STEREO) == 0) {
+		print_wx("This driver does not detect signal state");
+		return -1;
+	}
+	if (drv->set_freq == NULL || drv->get_state == NULL)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Tune to freq and take cycle samples of the card state
+ */
+void
+scan_probe(struct tuner_drv_t *drv, u_int16_t freq, u_int32_t cycle,
+    struct scan_rec_t *rec) {
+	u_int32_t i;
+	u_int64_t t;
+	int state;
+
+	memset(rec, 0, sizeof(*rec));
+	rec->freq = freq;
+	rec->samples = cycle;
+
+	t = USEC();
+	call_set_freq(drv, freq);
+	for (i = 0; i < cycle; i++) {
+		state = call_get_state(drv);
+		rec->state += state;
+		if (state & DRV_INFO_SIGNAL)
+			rec->signal++;
+		if (state & DRV_INFO_STEREO)
+			rec->stereo++;
+	}
+	rec->usec = USEC() - t;
+}
+
+/*
+ * Summed card state on freq, scaled to SEARCH_PROBE samples.
+ * With SPRT sampling stops as soon as the channel is settled
+ * to carry a station or not.
+ */
+int
+search_probe(struct tuner_drv_t *drv, u_int16_t freq) {
+	struct sprt_run_t run;
+	int c = SEARCH_PROBE;
+	int s = 0, state;
+
+	call_set_freq(drv, freq);
+
+	if (use_sprt == 0) {
+		while (c--)
+			s += call_get_state(drv);
+		return s;
+	}
+
+	sprt_start(&run);
+	do {
+		state = call_get_state(drv);
+		s += state;
+	} while (sprt_step(&sprt, &run, state != 0) == SPRT_CONTINUE);
+
+	return s * SEARCH_PROBE / run.n;
+}
+
 u_int16_t
 search_up_generic(struct tuner_drv_t *drv, u_int16_t freq) {
+	struct band_t *b = radio_band();
+	u_int16_t top = band_top(b);
 	int max = 0;
 	int platoe_start = 0;
 	int platoe_count = 0;
 	u_int16_t f = freq;
 
-	freq--;
+	/* Start at the first channel at or above freq */
+	freq = band_ceil(b, freq) - b->spacing;
 
-	while (freq < MAX_FM_FREQ) {
-		int c = SEARCH_PROBE;
-		int s = 0;
+	while (freq < top) {
+		int s;
 
-		drv->set_freq(++freq);
-
-		while (c--)
-			s += drv->get_state();
+		freq += b->spacing;
+		s = search_probe(drv, freq);
 
 		/* FIXME: more precise approximation */
 		if (s > max) {
@@ -593,8 +1492,8 @@ search_up_generic(struct tuner_drv_t *drv, u_int16_t freq) {
 				platoe_count++;
 		} else if (s < max) {
 			if (platoe_start) {
-				if (platoe_count > SEARCH_LENGTH) {
-					freq -= 2 * platoe_count / 3;
+				if (platoe_count * b->spacing > SEARCH_LENGTH) {
+					freq -= 2 * platoe_count / 3 * b->spacing;
 					break;
 				}
 			} else {
@@ -605,11 +1504,156 @@ search_up_generic(struct tuner_drv_t *drv, u_int16_t freq) {
 		}
 	}
 
-	if (freq < MAX_FM_FREQ) {
-		drv->set_freq(freq);
+	if (freq < top) {
+		call_set_freq(drv, freq);
 		return freq;
 	}
 
-	drv->set_freq(f);
+	call_set_freq(drv, f);
 	return f;
 }
+
+/*
+ * Driver callbacks, marked for port traffic traces
+ */
+int
+call_get_port(struct tuner_drv_t *drv, u_int32_t port) {
+	int ret;
+
+	MARK(PORTIO_CB_GET_PORT, port);
+	ret = drv->get_port(port);
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+int
+call_free_port(struct tuner_drv_t *drv) {
+	int ret;
+
+	MARK(PORTIO_CB_FREE_PORT, 0);
+	ret = drv->free_port();
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+int
+call_find_card(struct tuner_drv_t *drv) {
+	int ret;
+
+	MARK(PORTIO_CB_FIND_CARD, 0);
+	ret = drv->find_card();
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+void
+call_set_freq(struct tuner_drv_t *drv, u_int16_t freq) {
+	MARK(PORTIO_CB_SET_FREQ, freq);
+	drv->set_freq(freq);
+	MARK(PORTIO_CB_NONE, 0);
+}
+
+u_int16_t
+call_get_freq(struct tuner_drv_t *drv) {
+	u_int16_t ret;
+
+	MARK(PORTIO_CB_GET_FREQ, 0);
+	ret = drv->get_freq();
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+u_int16_t
+call_search(struct tuner_drv_t *drv, int dir, u_int16_t freq) {
+	u_int16_t ret;
+
+	MARK(PORTIO_CB_SEARCH, freq);
+	ret = drv->search(dir, freq);
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+void
+call_set_volu(struct tuner_drv_t *drv, int vol) {
+	MARK(PORTIO_CB_SET_VOLU, vol);
+	drv->set_volu(vol);
+	MARK(PORTIO_CB_NONE, 0);
+}
+
+int
+call_get_volu(struct tuner_drv_t *drv) {
+	int ret;
+
+	MARK(PORTIO_CB_GET_VOLU, 0);
+	ret = drv->get_volu();
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+void
+call_set_mono(struct tuner_drv_t *drv) {
+	MARK(PORTIO_CB_SET_MONO, 0);
+	drv->set_mono();
+	MARK(PORTIO_CB_NONE, 0);
+}
+
+int
+call_get_state(struct tuner_drv_t *drv) {
+	int ret;
+
+	MARK(PORTIO_CB_GET_STATE, 0);
+	ret = drv->get_state();
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+int
+call_get_level(struct tuner_drv_t *drv) {
+	int ret;
+
+	MARK(PORTIO_CB_GET_LEVEL, 0);
+	ret = drv->get_signal_level();
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+int
+call_get_dev(struct tuner_drv_t *drv) {
+	int ret;
+
+	MARK(PORTIO_CB_GET_DEV, 0);
+	ret = drv->get_deviation();
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+int
+call_use_port(struct tuner_drv_t *drv, u_int32_t port) {
+	int ret;
+
+	MARK(PORTIO_CB_USE_PORT, port);
+	ret = drv->use_port(port);
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
+
+int
+call_probe(struct tuner_drv_t *drv) {
+	int ret;
+
+	MARK(PORTIO_CB_PROBE, 0);
+	ret = drv->probe();
+	MARK(PORTIO_CB_NONE, ret);
+
+	return ret;
+}
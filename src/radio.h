@@ -39,6 +39,16 @@
 #define MIN_FM_FREQ	8750
 #define MAX_FM_FREQ	10800
 
+/* Band plan, frequencies in 10 kHz */
+struct band_t {
+	char *name;
+	u_int16_t min;		/* Lowest channel */
+	u_int16_t max;		/* Highest channel */
+	u_int16_t spacing;	/* Channel raster starting at min */
+};
+
+struct conf_detect_t;	/* conf.h */
+
 void radio_init(void);	/* Initialize drivers database */
 int radio_cleanup(void);
 
@@ -48,8 +58,17 @@ int radio_drv_free(void);
 int radio_get_port(void);
 int radio_free_port(void);
 int radio_test_port(void);
+int radio_trust_port(u_int32_t);
 
 void radio_set_freq(u_int16_t);
+int radio_check_freq(void);
+
+int radio_band_select(const char *);
+struct band_t *radio_band(void);
+u_int16_t radio_band_snap(u_int16_t);
+int radio_sprt_config(const char *);
+void radio_verbose(int);
+void radio_pci_sysfs(const char *);
 
 void radio_set_volume(int);
 void radio_set_mono(void);
@@ -66,10 +85,14 @@ int radio_info_volume(void);
 
 int radio_info_signal(void);
 int radio_info_stereo(void);
+int radio_info_signal_level(void);
 
-void radio_detect(void);
+int radio_detect(struct conf_detect_t *, int, int);
 void radio_scan(u_int16_t, u_int16_t, u_int32_t);
+void radio_scan_adaptive(u_int16_t, u_int16_t, u_int32_t, u_int16_t);
+void radio_stations(u_int16_t, u_int16_t, u_int32_t);
 u_int16_t radio_search(int, u_int16_t);
+void radio_bench(u_int16_t, int, u_int32_t);
 
 #ifndef NOMIXER
 int radio_mixer_init(void);
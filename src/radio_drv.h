@@ -91,6 +91,9 @@
 
 #define SEARCH_PROBE	15
 #define SEARCH_LENGTH	19
+#define SEARCH_LEVEL	50	/* Weakest peak taken for a station */
+#define SEARCH_LEVEL_PROBE	3
+#define SEARCH_AFC_STEPS	2	/* AFC corrections per station */
 
 #define TEST_FREQ	10630
 
@@ -120,6 +123,28 @@
 #define OUTB(a, b)	outb(a, b)
 #endif /* linux */
 
+#if defined PORTIO && !defined PORTIO_IMPL
+/* Route port i/o through the selected backend, see portio.h */
+#include "portio.h"
+
+#undef OUTL
+#undef OUTW
+#undef OUTB
+#undef inl
+#undef inw
+#undef inb
+#define OUTL(a, b)	portio_outl(a, b)
+#define OUTW(a, b)	portio_outw(a, b)
+#define OUTB(a, b)	portio_outb(a, b)
+#define inl(a)		portio_inl(a)
+#define inw(a)		portio_inw(a)
+#define inb(a)		portio_inb(a)
+
+/* Sleeps too, so they can be traced and simulated */
+#undef usleep
+#define usleep(a)	portio_usleep(a)
+#endif /* PORTIO && !PORTIO_IMPL */
+
 struct tuner_drv_t {
 	char *name;	/* Full card name */
 	char *drv;	/* Shord driver name */
@@ -142,6 +167,8 @@ struct tuner_drv_t {
 						   - maximal value first */
 #define DRV_INFO_VOL_SEPARATE	(1 << 17)	/* Volume may be managed
 						   separately from frequency */
+#define DRV_INFO_GETS_LEVEL	(1 << 18)	/* Knows signal level */
+#define DRV_INFO_GETS_AFC	(1 << 19)	/* Knows tuning deviation */
 
 	int (*get_port)(u_int32_t);	/* Get port access */
 	int (*free_port)(void);		/* Release port */
@@ -152,6 +179,7 @@ struct tuner_drv_t {
 	u_int16_t (*get_freq)(void);	/* Get frequency */
 
 	u_int16_t (*search)(int, u_int16_t);	/* Hardware search up/down */
+#define DRV_SEARCH_TIMEOUT	0xffff	/* Nothing found, tuned back */
 
 	void (*set_volu)(int);		/* Set volume */
 	int (*get_volu)(void);		/* Get volume */
@@ -161,6 +189,18 @@ struct tuner_drv_t {
 	int (*get_state)(void);		/* Get signal/stereo status */
 #define DRV_INFO_SIGNAL	(1 << 0)
 #define DRV_INFO_STEREO	(1 << 1)
+
+	int (*get_signal_level)(void);	/* Get signal level */
+#define DRV_INFO_MAX_LEVEL	100
+
+	int (*get_deviation)(void);	/* Get AFC deviation in kHz,
+					   positive - station is above */
+
+	int (*use_port)(u_int32_t);	/* Take the port find_card found
+					   before, instead of finding it */
+
+	int (*probe)(void);		/* Read-only check of a scanned card,
+					   0 - certainly no card at the port */
 };
 
 typedef struct tuner_drv_t *(*EXPORT_FUNC)(void);
@@ -188,6 +228,7 @@ int radio_device_get(const char *, const char *, int);
 int radio_device_release(int, const char *);
 
 u_int16_t pci_bus_locate(struct pci_dev_t *);
+u_int32_t pci_fingerprint(void);
 
 void print_w(const char *, ...);
 void print_wx(const char *, ...);
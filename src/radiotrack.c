@@ -28,6 +28,7 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "lm700x.h"
 #include "radio_drv.h"
 
@@ -70,6 +71,10 @@ static u_int32_t radioport = 0;
 static int tunertype = RADIOTRACK;
 static int stereo = LM700X_STEREO;
 
+static struct bitbang_t bb = {
+	0, BITBANG_LSB_FIRST, 2, { 0xd1, 0xd3 }, { 0xd5, 0xd7 }, 0, 0
+};
+
 /******************************************************************/
 
 struct tuner_drv_t *
@@ -85,6 +90,7 @@ export_sfi(void) {
 int
 get_port_rt(u_int32_t port) {
 	radioport = port;
+	bitbang_flush(&bb);
 	switch (port) {
 	case 0x20c:
 	case 0x30c:
@@ -113,26 +119,22 @@ info_port_rt(void) {
 
 void
 set_freq_rt(u_int16_t frequency) {
+	struct bitbang_wave_t *w;
 	u_int32_t reg = 0;
-	int i;
 
 	if (tunertype == UNKNOWN)
 		return;
 
-	reg  = lm700x_encode_freq(frequency, LM700X_REF_050);
-	reg |= stereo | LM700X_REF_050 | LM700X_DIVIDER_FM;
+	if (bitbang_lookup(&bb, frequency | (stereo == LM700X_MONO) << 16,
+	    &w) == 0) {
+		reg  = lm700x_encode_freq(frequency, LM700X_REF_050);
+		reg |= stereo | LM700X_REF_050 | LM700X_DIVIDER_FM;
 
-	if (tunertype == SF16_FMI)
-		OUTB(radioport, 0);
-
-	for (i = 0; i < LM700X_REGISTER_LENGTH; i++)
-		if (reg & (1 << i)) {
-			OUTB(radioport, 0xd5);
-			OUTB(radioport, 0xd7);
-		} else {
-			OUTB(radioport, 0xd1);
-			OUTB(radioport, 0xd3);
-		}
+		if (tunertype == SF16_FMI)
+			bitbang_put(w, 0);
+		bitbang_encode(&bb, w, reg, LM700X_REGISTER_LENGTH);
+	}
+	bitbang_emit(&bb, radioport, w);
 
 	if (tunertype == RADIOTRACK) {
 		usleep(1000);
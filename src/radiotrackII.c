@@ -28,6 +28,7 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "radio_drv.h"
 #include "tea5757.h"
 
@@ -55,8 +56,6 @@ struct tuner_drv_t rtii_drv = {
 	mute_rtii, NULL, mono_rtii, state_rtii
 };
 
-static void send_zero(void);
-static void send_one(void);
 static void write_shift_register(u_int32_t);
 static u_int32_t read_shift_register(void);
 
@@ -64,6 +63,10 @@ static struct tea5757_t card = {
 	TEA5757_SEARCH_END, 0, TEA5757_S030, TEA5757_STEREO,
 	read_shift_register, write_shift_register
 };
+
+static struct bitbang_t bb = {
+	0, BITBANG_MSB_FIRST, 3, { 0x01, 0x03, 0x01 }, { 0x05, 0x07, 0x05 }, 0, 0
+};
 static u_int32_t radioport = 0;
 
 /******************************************************************/
@@ -75,6 +78,7 @@ export_rtii(void) {
 
 int
 get_port_rtii(u_int32_t port) {
+	tea5757_invalidate(&card);
 	radioport = port;
 	return radio_get_ioperms(radioport, 1);
 }
@@ -131,35 +135,18 @@ mono_rtii(void) {
 	card.stereo = TEA5757_MONO;
 }
 
-static void
-send_zero(void) {
-	OUTB(radioport, 0x01);
-	OUTB(radioport, 0x03);
-	OUTB(radioport, 0x01);
-}
-
-static void
-send_one(void) {
-	OUTB(radioport, 0x05);
-	OUTB(radioport, 0x07);
-	OUTB(radioport, 0x05);
-}
-
 static void
 write_shift_register(u_int32_t data) {
-	int c = 25;
-
-	OUTB(radioport, 0xc8);
-	OUTB(radioport, 0xc9);
-	OUTB(radioport, 0xc9);
-
-	while (c--)
-		if (data & (1 << c))
-			send_one();
-		else
-			send_zero();
-
-	OUTB(radioport, 0xc8);
+	struct bitbang_wave_t *w;
+
+	if (bitbang_lookup(&bb, data, &w) == 0) {
+		bitbang_put(w, 0xc8);
+		bitbang_put(w, 0xc9);
+		bitbang_put(w, 0xc9);
+		bitbang_encode(&bb, w, data, 25);
+		bitbang_put(w, 0xc8);
+	}
+	bitbang_emit(&bb, radioport, w);
 }
 
 static u_int32_t
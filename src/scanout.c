@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * scan output formats
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ostypes.h"
+
+#include "scanout.h"
+
+static char *names[SCANOUT_FORMATS] = { "text", "csv", "jsonl", "binary" };
+
+static FILE *out = NULL;
+static int format = SCANOUT_TEXT;
+static char buf[SCANOUT_BUFSIZE];
+
+static void put32(u_int8_t *, u_int32_t);
+
+/*
+ * Returns the format called name, or -1
+ */
+int
+scanout_format(const char *name) {
+	int i;
+
+	if (name == NULL)
+		return -1;
+
+	for (i = 0; i < SCANOUT_FORMATS; i++)
+		if (strcmp(name, names[i]) == 0)
+			return i;
+
+	/* Short aliases */
+	if (strcmp(name, "bin") == 0)
+		return SCANOUT_BINARY;
+	if (strcmp(name, "json") == 0)
+		return SCANOUT_JSONL;
+
+	return -1;
+}
+
+char *
+scanout_format_name(int fmt) {
+	return fmt >= 0 && fmt < SCANOUT_FORMATS ? names[fmt] : "unknown";
+}
+
+/*
+ * Must be called before anything is written to f
+ */
+int
+scanout_open(FILE *f, int fmt) {
+	if (fmt < 0 || fmt >= SCANOUT_FORMATS)
+		return -1;
+
+	out = f;
+	format = fmt;
+
+	if (format != SCANOUT_TEXT)
+		setvbuf(out, buf, _IOFBF, sizeof(buf));
+
+	switch (format) {
+	case SCANOUT_CSV:
+		fprintf(out, "freq_khz,state,signal,stereo,samples,usec\n");
+		break;
+	case SCANOUT_BINARY:
+		fwrite(SCANOUT_MAGIC, SCANOUT_MAGICLEN, 1, out);
+		break;
+	}
+
+	return ferror(out) ? -1 : 0;
+}
+
+int
+scanout_write(struct scan_rec_t *rec) {
+	u_int8_t b[SCANOUT_RECLEN];
+
+	if (out == NULL)
+		out = stdout;
+
+	switch (format) {
+	case SCANOUT_TEXT:
+		fprintf(out, "%.2f => %lu\n", (float)rec->freq / 100,
+		    (unsigned long)rec->state);
+		break;
+	case SCANOUT_CSV:
+		fprintf(out, "%lu,%lu,%lu,%lu,%lu,%lu\n",
+		    (unsigned long)rec->freq * 10,
+		    (unsigned long)rec->state, (unsigned long)rec->signal,
+		    (unsigned long)rec->stereo, (unsigned long)rec->samples,
+		    (unsigned long)rec->usec);
+		break;
+	case SCANOUT_JSONL:
+		fprintf(out, "{\"freq_khz\":%lu,\"state\":%lu,\"signal\":%lu,"
+		    "\"stereo\":%lu,\"samples\":%lu,\"usec\":%lu}\n",
+		    (unsigned long)rec->freq * 10,
+		    (unsigned long)rec->state, (unsigned long)rec->signal,
+		    (unsigned long)rec->stereo, (unsigned long)rec->samples,
+		    (unsigned long)rec->usec);
+		break;
+	case SCANOUT_BINARY:
+		b[0] = rec->freq & 0xff;
+		b[1] = rec->freq >> 8;
+		b[2] = b[3] = 0;
+		put32(b + 4, rec->samples);
+		put32(b + 8, rec->state);
+		put32(b + 12, rec->signal);
+		put32(b + 16, rec->stereo);
+		put32(b + 20, rec->usec);
+		fwrite(b, sizeof(b), 1, out);
+		break;
+	}
+
+	return ferror(out) ? -1 : 0;
+}
+
+/*
+ * Flushes the output, the caller closes the file
+ */
+int
+scanout_close(void) {
+	int ret;
+
+	if (out == NULL)
+		return 0;
+
+	ret = fflush(out) == 0 && ferror(out) == 0 ? 0 : -1;
+	out = NULL;
+	format = SCANOUT_TEXT;
+
+	return ret;
+}
+
+/* INTERNAL STUFF */
+static void
+put32(u_int8_t *b, u_int32_t v) {
+	int i;
+
+	for (i = 0; i < 4; i++)
+		b[i] = (v >> (8 * i)) & 0xff;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * scan output formats
+ *
+ *   text	"98.00 => 2", what fmio -S always printed
+ *   csv	header line, then one line per frequency
+ *   jsonl	one JSON object per line
+ *   binary	magic, then fixed size records, see below
+ *
+ * Frequencies are in kHz for csv and jsonl, in 10 kHz units in binary
+ * records. Anything but text is fully buffered.
+ */
+
+#ifndef SCANOUT_H__
+#define SCANOUT_H__
+
+#include <stdio.h>
+
+#define SCANOUT_TEXT		0
+#define SCANOUT_CSV		1
+#define SCANOUT_JSONL		2
+#define SCANOUT_BINARY		3
+#define SCANOUT_FORMATS		4
+
+/*
+ * Binary output: magic, then little-endian 24-byte records
+ *   freq:16 reserved:16 samples:32 state:32 signal:32 stereo:32 usec:32
+ */
+#define SCANOUT_MAGIC		"FMIOSCN1"
+#define SCANOUT_MAGICLEN	8
+#define SCANOUT_RECLEN		24
+
+#define SCANOUT_BUFSIZE		8192
+
+struct scan_rec_t {
+	u_int16_t freq;		/* 10 kHz units */
+	u_int32_t samples;	/* get_state calls */
+	u_int32_t state;	/* Sum of what get_state returned */
+	u_int32_t signal;	/* Samples with signal */
+	u_int32_t stereo;	/* Samples with stereo */
+	u_int32_t usec;		/* Time the step took */
+};
+
+int scanout_format(const char *);
+char *scanout_format_name(int);
+int scanout_open(FILE *, int);
+int scanout_write(struct scan_rec_t *);
+int scanout_close(void);
+
+#endif /* SCANOUT_H__ */
@@ -30,6 +30,7 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "radio_drv.h"
 
 #define SF16FMD2_CAPS		DRV_INFO_NEEDS_ROOT | DRV_INFO_MONOSTEREO | \
@@ -56,8 +57,14 @@ static int stereo = 1;
 static u_int32_t radioport = 0;
 
 static void inbits(int);
-static void send_zero(int);
-static void send_one(int);
+
+/* Mode bits want three dummy reads per write, frequency bits two */
+static struct bitbang_t bb_mode = {
+	0, BITBANG_LSB_FIRST, 3, { 0x00, 0x02, 0x00 }, { 0x01, 0x03, 0x01 }, 0, 3
+};
+static struct bitbang_t bb_freq = {
+	0, BITBANG_MSB_FIRST, 3, { 0x00, 0x02, 0x00 }, { 0x01, 0x03, 0x01 }, 0, 2
+};
 
 /******************************************************************/
 
@@ -84,42 +91,29 @@ info_port_sf16fmd2(void) {
 
 void
 set_freq_sf16fmd2(u_int16_t frequency) {
-	int c = 0x0f;
-	u_int16_t freq = (u_int16_t)
-		((float)frequency*0.7985714+871.28571);
-
-	/* Search end - station found */
-	send_zero(3);
-
-	/* Search down */
-	send_zero(3);
-
-	/* Stereo/Forced Mono */
-	if (stereo)
-		send_zero(3);
-	else
-		send_one(3);
-
-	/* FM band */
-	send_zero(3);
-	send_zero(3);
-
-	/* Band switch */
-	send_zero(3);
-	send_zero(3);
-
-	/* Locking field strength during search > 30 mkV */
-	send_one(3);
-	send_zero(3);
-
-	/* Dummy */
-	send_zero(3);
-
-	while (c--)
-		if (freq & (1 << c))
-			send_one(2);
-		else
-			send_zero(2);
+	struct bitbang_wave_t *w;
+	u_int32_t mode = 0ul;
+	u_int16_t freq;
+
+	/*
+	 * Mode bits, first sent first:
+	 *  search end - station found, search down,
+	 *  stereo/forced mono, FM band (2 bits), band switch (2 bits),
+	 *  locking field strength during search > 30 mkV (2 bits), dummy
+	 */
+	if (!stereo)
+		mode |= 1 << 2;
+	mode |= 1 << 7;
+
+	if (bitbang_lookup(&bb_mode, mode, &w) == 0)
+		bitbang_encode(&bb_mode, w, mode, 10);
+	bitbang_emit(&bb_mode, radioport, w);
+
+	if (bitbang_lookup(&bb_freq, frequency, &w) == 0) {
+		freq = (u_int16_t)((float)frequency*0.7985714+871.28571);
+		bitbang_encode(&bb_freq, w, freq, 15);
+	}
+	bitbang_emit(&bb_freq, radioport, w);
 
 	usleep(AFC_DELAY);
 	return;
@@ -137,26 +131,6 @@ inbits(int c) {
 		inb(radioport);
 }
 
-static void
-send_one(int c) {
-	OUTB(radioport, 0x01);
-	inbits(c);
-	OUTB(radioport, 0x03);
-	inbits(c);
-	OUTB(radioport, 0x01);
-	inbits(c);
-}
-
-static void
-send_zero(int c) {
-	OUTB(radioport, 0x00);
-	inbits(c);
-	OUTB(radioport, 0x02);
-	inbits(c);
-	OUTB(radioport, 0x00);
-	inbits(c);
-}
-
 void
 mono_sf16fmd2(void) {
 	stereo = 0;
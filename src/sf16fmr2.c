@@ -28,6 +28,7 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "pt2254a.h"
 #include "radio_drv.h"
 #include "tea5757.h"
@@ -69,7 +70,11 @@ static int type = SF16FMR2_NOAMP;
 
 static struct tea5757_t card = {
 	TEA5757_SEARCH_END, 0, TEA5757_S030, TEA5757_STEREO,
-	read_shift_register, write_shift_register
+	read_shift_register, write_shift_register, 1 << 26
+};
+
+static struct bitbang_t bb = {
+	0, BITBANG_MSB_FIRST, 2, { 0x00, 0x02 }, { 0x01, 0x03 }, 0, 0
 };
 
 struct tuner_drv_t sf16fmr2_drv = {
@@ -90,6 +95,7 @@ export_sf16fmr2(void) {
 
 int
 get_port_sf16fmr2(u_int32_t port) {
+	tea5757_invalidate(&card);
 	return radio_get_ioperms(radioport, 1) < 0 ? -1 : 0;
 }
 
@@ -191,21 +197,15 @@ read_shift_register(void) {
 
 static void
 write_shift_register(u_int32_t data) {
-	int c = 25;
-
-	OUTB(radioport, 0x00);
+	struct bitbang_wave_t *w;
 
-	while (c--)
-		if (data & (1 << c)) {
-			OUTB(radioport, 0x01);
-			OUTB(radioport, 0x03);
-		} else {
-			OUTB(radioport, 0x00);
-			OUTB(radioport, 0x02);
-		}
-
-	OUTB(radioport, 0x00);
-	OUTB(radioport, 0x04);
+	if (bitbang_lookup(&bb, data, &w) == 0) {
+		bitbang_put(w, 0x00);
+		bitbang_encode(&bb, w, data, 25);
+		bitbang_put(w, 0x00);
+		bitbang_put(w, 0x04);
+	}
+	bitbang_emit(&bb, radioport, w);
 }
 
 int
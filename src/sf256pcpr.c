@@ -31,6 +31,8 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
+#include "delay.h"
 #include "radio_drv.h"
 #include "tea5757.h"
 
@@ -43,6 +45,7 @@ void set_volume_sf256pcpr(int);
 int get_port_sf256pcpr(u_int32_t);
 int free_port_sf256pcpr(void);
 u_int32_t info_port_sf256pcpr(void);
+int use_port_sf256pcpr(u_int32_t);
 int find_card_sf256pcpr(void);
 void set_frequency_sf256pcpr(u_int16_t);
 u_int16_t get_frequency_sf256pcpr(void);
@@ -56,11 +59,11 @@ struct tuner_drv_t sf256pcpr_drv = {
 	get_port_sf256pcpr, free_port_sf256pcpr, info_port_sf256pcpr,
 	find_card_sf256pcpr, set_frequency_sf256pcpr,
 	get_frequency_sf256pcpr, search_sf256pcpr,
-	set_volume_sf256pcpr, NULL, mono_sf256pcpr, state_sf256pcpr
+	set_volume_sf256pcpr, NULL, mono_sf256pcpr, state_sf256pcpr,
+	NULL, NULL, use_port_sf256pcpr
 };
 
-static void send_zero(void);
-static void send_one(void);
+static u_int32_t locate_card(void);
 static u_int32_t read_shift_register(void);
 static void write_shift_register(u_int32_t);
 static u_int32_t read_shift_register(void);
@@ -71,6 +74,11 @@ static struct tea5757_t card = {
 	read_shift_register, write_shift_register
 };
 
+static struct bitbang_t bb = {
+	1, BITBANG_MSB_FIRST, 3,
+	{ 0xf800, 0xf801, 0xf800 }, { 0xf802, 0xf803, 0xf802 }, 0, 0
+};
+
 /*********************************************************************/
 
 struct tuner_drv_t *
@@ -80,6 +88,7 @@ export_sf256pcpr(void) {
 
 int
 get_port_sf256pcpr(u_int32_t port) {
+	tea5757_invalidate(&card);
 	return radio_get_iopl() < 0 ? -1 : 0;
 }
 
@@ -93,12 +102,42 @@ info_port_sf256pcpr(void) {
 	return radioport;
 }
 
+/*
+ * Port of the tuner, 0 if there is no such PCI device
+ */
+static u_int32_t
+locate_card(void) {
+	struct pci_dev_t pd = {
+		0x1319 /* vendor id */, 0x0801 /* device id */,
+		0x1319 /* subsystem vendor id */, 0x1319 /* subsystem id */,
+		PCI_SUBCLASS_MULTIMEDIA_AUDIO, 0xb2
+	};
+	u_int16_t base;
+
+	if ((base = pci_bus_locate(&pd)) == 0)
+		return 0;
+
+	return base + 0x52;
+}
+
+int
+use_port_sf256pcpr(u_int32_t port) {
+	/* The port comes from a file the user can write */
+	if (port == 0 || port != locate_card()) {
+		errno = ENXIO;
+		return -1;
+	}
+
+	radioport = port;
+	return 0;
+}
+
 void
 set_volume_sf256pcpr(int volu) {
 	u_int16_t value = volu ? 0xf804 : 0xf800;
 
 	OUTW(radioport, value);
-	usleep(6);
+	delay_usec(6);
 	OUTW(radioport, value);
 }
 
@@ -140,33 +179,16 @@ mono_sf256pcpr(void) {
 	card.stereo = TEA5757_MONO;
 }
 
-static void
-send_zero(void) {
-	OUTW(radioport, 0xf800);
-	OUTW(radioport, 0xf801);
-	OUTW(radioport, 0xf800);
-}
-
-static void
-send_one(void) {
-	OUTW(radioport, 0xf802);
-	OUTW(radioport, 0xf803);
-	OUTW(radioport, 0xf802);
-}
-
 static void
 write_shift_register(u_int32_t data) {
-	int c = 25;
+	struct bitbang_wave_t *w;
 
-	OUTW(radioport, 0xf800);
-
-	while (c--)
-		if (data & (1 << c))
-			send_one();
-		else
-			send_zero();
-
-	OUTW(radioport, 0xf804);
+	if (bitbang_lookup(&bb, data, &w) == 0) {
+		bitbang_put(w, 0xf800);
+		bitbang_encode(&bb, w, data, 25);
+		bitbang_put(w, 0xf804);
+	}
+	bitbang_emit(&bb, radioport, w);
 }
 
 static u_int32_t
@@ -193,18 +215,10 @@ find_card_sf256pcpr(void) {
 	u_int16_t cur_freq, test_freq = 0ul;
 	int err = -1;
 
-	struct pci_dev_t pd = {
-		0x1319 /* vendor id */, 0x0801 /* device id */,
-		0x1319 /* subsystem vendor id */, 0x1319 /* subsystem id */,
-		PCI_SUBCLASS_MULTIMEDIA_AUDIO, 0xb2
-	};
-
-	radioport = pci_bus_locate(&pd);
-	if (radioport == 0) {
+	if ((radioport = locate_card()) == 0) {
 		errno = ENXIO;
 		return -1;
 	}
-	radioport += 0x52;
 
 	/* Save old value */
 	cur_freq = get_frequency_sf256pcpr();
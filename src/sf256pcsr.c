@@ -31,6 +31,8 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
+#include "delay.h"
 #include "radio_drv.h"
 #include "tea5757.h"
 
@@ -50,6 +52,7 @@
 int get_port_sf256pcs(u_int32_t);
 int free_port_sf256pcs(void);
 u_int32_t info_port_sf256pcs(void);
+int use_port_sf256pcs(u_int32_t);
 int find_card_sf256pcs(void);
 void set_frequency_sf256pcs(u_int16_t);
 u_int16_t get_frequency_sf256pcs(void);
@@ -63,12 +66,12 @@ static struct tuner_drv_t sf256pcs_drv = {
 	"stx", NULL, 0, SF256_CAPS, get_port_sf256pcs,
 	free_port_sf256pcs, info_port_sf256pcs, find_card_sf256pcs,
 	set_frequency_sf256pcs, get_frequency_sf256pcs, search_sf256pcs,
-	set_volume_sf256pcs, NULL, mono_sf256pcs, NULL
+	set_volume_sf256pcs, NULL, mono_sf256pcs, NULL,
+	NULL, NULL, use_port_sf256pcs
 };
 
 /* Internal functions */
-static void send_zero(void);
-static void send_one(void);
+static u_int32_t locate_card(void);
 static u_int32_t read_shift_register(void);
 static void write_shift_register(u_int32_t);
 static u_int32_t read_shift_register(void);
@@ -81,6 +84,11 @@ static struct tea5757_t card = {
 	read_shift_register, write_shift_register
 };
 
+static struct bitbang_t bb = {
+	1, BITBANG_MSB_FIRST, 3,
+	{ 0xe000, 0xe008, 0xe000 }, { 0xe002, 0xe00a, 0xe002 }, 0, 0
+};
+
 /************* EXPORT ************************************************/
 struct tuner_drv_t *
 export_sf256pcs(void) {
@@ -91,6 +99,7 @@ export_sf256pcs(void) {
 
 int
 get_port_sf256pcs(u_int32_t port) {
+	tea5757_invalidate(&card);
 	return radio_get_iopl() < 0 ? -1 : 0;
 }
 
@@ -104,29 +113,45 @@ info_port_sf256pcs(void) {
 	return radioport;
 }
 
+/*
+ * Port of the tuner, 0 if there is no such PCI device
+ */
+static u_int32_t
+locate_card(void) {
+	struct pci_dev_t pd = {
+		PCI_VENDOR_ID_FORTEMEDIA, PCI_DEVICE_ID_FORTEMEDIA_FM801,
+		PCI_SUBSYS_ID_ANY, PCI_SUBSYS_ID_ANY, PCI_SUBCLASS_ANY,
+		PCI_REVISION_ANY
+	};
+	u_int16_t base;
+
+	if ((base = pci_bus_locate(&pd)) == 0)
+		return 0;
+
+	return base + 0x52;
+}
+
+int
+use_port_sf256pcs(u_int32_t port) {
+	/* The port comes from a file the user can write */
+	if (port == 0 || port != locate_card()) {
+		errno = ENXIO;
+		return -1;
+	}
+
+	radioport = port;
+	return 0;
+}
+
 void
 set_volume_sf256pcs(int volu) {
 	u_int16_t value = volu ? 0xe004 : 0xe000;
 
 	OUTW(radioport, value);
-	usleep(6);
+	delay_usec(6);
 	OUTW(radioport, value);
 }
 
-static void
-send_zero(void) {
-	OUTW(radioport, 0xe000);
-	OUTW(radioport, 0xe008);
-	OUTW(radioport, 0xe000);
-}
-
-static void
-send_one(void) {
-	OUTW(radioport, 0xe002);
-	OUTW(radioport, 0xe00a);
-	OUTW(radioport, 0xe002);
-}
-
 /*
  * Set frequency and other stuff
  * Basically, this is just writing the 25-bit shift register
@@ -146,17 +171,14 @@ mono_sf256pcs(void) {
 
 static void
 write_shift_register(u_int32_t data) {
-	int c = 25;
+	struct bitbang_wave_t *w;
 
-	OUTW(radioport, 0xe000);
-
-	while (c--)
-		if (data & (1 << c))
-			send_one();
-		else
-			send_zero();
-
-	OUTW(radioport, 0xe004);
+	if (bitbang_lookup(&bb, data, &w) == 0) {
+		bitbang_put(w, 0xe000);
+		bitbang_encode(&bb, w, data, 25);
+		bitbang_put(w, 0xe004);
+	}
+	bitbang_emit(&bb, radioport, w);
 }
 
 u_int32_t
@@ -185,18 +207,11 @@ int
 find_card_sf256pcs(void) {
 	u_int32_t cur_freq, test_freq = 0ul;
 	int err = -1;
-	struct pci_dev_t pd = {
-		PCI_VENDOR_ID_FORTEMEDIA, PCI_DEVICE_ID_FORTEMEDIA_FM801,
-		PCI_SUBSYS_ID_ANY, PCI_SUBSYS_ID_ANY, PCI_SUBCLASS_ANY,
-		PCI_REVISION_ANY
-	};
 
-	radioport = pci_bus_locate(&pd);
-	if (radioport == 0) {
+	if ((radioport = locate_card()) == 0) {
 		errno = ENXIO;
 		return -1;
 	}
-	radioport += 0x52;
 
 	/* Save old value */
 	cur_freq = get_frequency_sf256pcs();
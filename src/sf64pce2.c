@@ -12,6 +12,7 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "radio_drv.h"
 #include "tea5757.h"
 
@@ -30,6 +31,7 @@
 int get_port_sf64pce2(u_int32_t);
 int free_port_sf64pce2(void);
 u_int32_t info_port_sf64pce2(void);
+int use_port_sf64pce2(u_int32_t);
 int find_card_sf64pce2(void);
 void set_frequency_sf64pce2(u_int16_t);
 u_int16_t get_frequency_sf64pce2(void);
@@ -42,10 +44,12 @@ struct tuner_drv_t pce2_drv = {
 	"SoundForte Awesome 64R SF64-PCE2", "sae", NULL, 0, SF64PCE2_CAPS,
 	get_port_sf64pce2, free_port_sf64pce2, info_port_sf64pce2,
 	find_card_sf64pce2, set_frequency_sf64pce2, get_frequency_sf64pce2,
-	search_sf64pce2, mute_sf64pce2, NULL, mono_sf64pce2, state_sf64pce2
+	search_sf64pce2, mute_sf64pce2, NULL, mono_sf64pce2, state_sf64pce2,
+	NULL, NULL, use_port_sf64pce2
 };
 
 static void write_shift_register(u_int32_t);
+static u_int32_t locate_card(void);
 static u_int32_t read_shift_register(void);
 
 static u_int32_t radioport = 0;
@@ -67,6 +71,10 @@ static int TEA_wren = 0x100;  /* wren = "WRite ENable" */
 static int TEA_most = 0x200; 
 /* Note: above bits has the proprietary side-effect of Muting the card!? */
 
+static struct bitbang_t bb = {
+	1, BITBANG_MSB_FIRST, 3, { 0 }, { 0 }, 0, 0
+};
+
 /*********************************************************************/
 
 struct tuner_drv_t *
@@ -76,6 +84,12 @@ export_sf64pce2(void) {
 
 int
 get_port_sf64pce2(u_int32_t port) {
+	tea5757_invalidate(&card);
+	bitbang_flush(&bb);
+	bb.zero[0] = bb.zero[2] = TEA_wren;
+	bb.zero[1] = TEA_wren | TEA_clk;
+	bb.one[0] = bb.one[2] = TEA_wren | TEA_data;
+	bb.one[1] = TEA_wren | TEA_clk | TEA_data;
 	return radio_get_iopl() < 0 ? -1 : 0;
 }
 
@@ -89,6 +103,36 @@ info_port_sf64pce2(void) {
 	return radioport;
 }
 
+/*
+ * Port of the tuner, 0 if there is no such PCI device
+ */
+static u_int32_t
+locate_card(void) {
+	struct pci_dev_t pd = {
+		PCI_VENDOR_ID_ESS, PCI_DEVICE_ID_MAESTRO2,
+		PCI_SUBSYS_ID_ANY, PCI_SUBSYS_ID_ANY, PCI_SUBCLASS_ANY,
+		PCI_REVISION_ANY
+	};
+	u_int16_t base;
+
+	if ((base = pci_bus_locate(&pd)) == 0)
+		return 0;
+
+	return base + 0x60;
+}
+
+int
+use_port_sf64pce2(u_int32_t port) {
+	/* The port comes from a file the user can write */
+	if (port == 0 || port != locate_card()) {
+		errno = ENXIO;
+		return -1;
+	}
+
+	radioport = port;
+	return 0;
+}
+
 /* Todo */
 void
 mute_sf64pce2(int v) {
@@ -154,7 +198,7 @@ mono_sf64pce2(void) {
 
 static void
 write_shift_register(u_int32_t data) {
-	int c = 25, bit;
+	struct bitbang_wave_t *w;
 
 	/* enable writes */
 	OUTW(radioport + 4, ~(TEA_data | TEA_clk | TEA_wren));
@@ -166,23 +210,17 @@ write_shift_register(u_int32_t data) {
 	 * is not documented in the datasheet) (this is helpful if CLK
 	 * was triggered by accident or else...)
 	 */
-	OUTW(radioport, TEA_wren);
-	OUTW(radioport, TEA_wren);
-	OUTW(radioport, 0);
-	OUTW(radioport, 0);
-	OUTW(radioport, TEA_wren);
-	OUTW(radioport, TEA_wren);
-
-	while (c--) {
-		if (data & (1 << c)) 
-			bit = TEA_data;
-		else
-			bit = 0;
-		OUTW(radioport, TEA_wren | bit);
-		OUTW(radioport, TEA_wren | bit | TEA_clk);
-		OUTW(radioport, TEA_wren | bit);
+	if (bitbang_lookup(&bb, data, &w) == 0) {
+		bitbang_put(w, TEA_wren);
+		bitbang_put(w, TEA_wren);
+		bitbang_put(w, 0);
+		bitbang_put(w, 0);
+		bitbang_put(w, TEA_wren);
+		bitbang_put(w, TEA_wren);
+		bitbang_encode(&bb, w, data, 25);
+		bitbang_put(w, 0);	/* This is needed to un-mute SF64-PCE2! */
 	}
-	OUTW(radioport,0);  /* This is needed to un-mute SF64-PCE2! */
+	bitbang_emit(&bb, radioport, w);
 }
 
 u_int32_t
@@ -213,18 +251,11 @@ int
 find_card_sf64pce2(void) {
 	u_int16_t cur_freq, test_freq = 0ul;
 	int err = -1;
-	struct pci_dev_t pd = {
-		PCI_VENDOR_ID_ESS, PCI_DEVICE_ID_MAESTRO2,
-		PCI_SUBSYS_ID_ANY, PCI_SUBSYS_ID_ANY, PCI_SUBCLASS_ANY,
-		PCI_REVISION_ANY
-	};
 
-	radioport = pci_bus_locate(&pd);
-	if (radioport == 0) {
+	if ((radioport = locate_card()) == 0) {
 		errno = ENXIO;
 		return -1;
 	}
-	radioport += 0x60;
 
 	/* Save old value */
 	cur_freq = get_frequency_sf64pce2();
@@ -31,6 +31,8 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
+#include "delay.h"
 #include "radio_drv.h"
 #include "tea5757.h"
 
@@ -52,6 +54,7 @@
 int get_port_sf64pcr(u_int32_t);
 int free_port_sf64pcr(void);
 u_int32_t info_port_sf64pcr(void);
+int use_port_sf64pcr(u_int32_t);
 int find_card_sf64pcr(void);
 u_int16_t get_frequency_sf64pcr(void);
 void set_frequency_sf64pcr(u_int16_t);
@@ -64,11 +67,11 @@ struct tuner_drv_t sf64pcr_drv = {
 	"sf4r", NULL, 0, SF64PCR_CAPS,
 	get_port_sf64pcr, free_port_sf64pcr, info_port_sf64pcr,
 	find_card_sf64pcr, set_frequency_sf64pcr, get_frequency_sf64pcr,
-	NULL, mute_sf64pcr, NULL, mono_sf64pcr, state_sf64pcr
+	NULL, mute_sf64pcr, NULL, mono_sf64pcr, state_sf64pcr,
+	NULL, NULL, use_port_sf64pcr
 };
 
-static void send_zero(void);
-static void send_one(void);
+static u_int32_t locate_card(void);
 static u_int32_t read_shift_register(void);
 static void write_shift_register(u_int32_t);
 static u_int32_t read_shift_register(void);
@@ -76,7 +79,12 @@ static u_int32_t read_shift_register(void);
 static u_int32_t radioport = 0;
 static struct tea5757_t card = {
 	TEA5757_SEARCH_END, 0, TEA5757_S030, TEA5757_STEREO,
-	read_shift_register, write_shift_register
+	read_shift_register, write_shift_register, DRV_INFO_SIGNAL << 25
+};
+
+static struct bitbang_t bb = {
+	1, BITBANG_MSB_FIRST, 3,
+	{ 0xf800, 0xf801, 0xf800 }, { 0xf804, 0xf805, 0xf804 }, 0, 0
 };
 
 /*********************************************************************/
@@ -88,6 +96,7 @@ export_sf64pcr(void) {
 
 int
 get_port_sf64pcr(u_int32_t port) {
+	tea5757_invalidate(&card);
 	return radio_get_iopl() < 0 ? -1 : 0;
 }
 
@@ -101,12 +110,42 @@ info_port_sf64pcr(void) {
 	return radioport;
 }
 
+/*
+ * Port of the tuner, 0 if there is no such PCI device
+ */
+static u_int32_t
+locate_card(void) {
+	struct pci_dev_t pd = {
+		PCI_VENDOR_ID_FORTEMEDIA, PCI_DEVICE_ID_FORTEMEDIA_FM801,
+		PCI_SUBSYS_ID_ANY, PCI_SUBSYS_ID_ANY, PCI_SUBCLASS_ANY,
+		PCI_REVISION_ANY
+	};
+	u_int16_t base;
+
+	if ((base = pci_bus_locate(&pd)) == 0)
+		return 0;
+
+	return base + 0x52;
+}
+
+int
+use_port_sf64pcr(u_int32_t port) {
+	/* The port comes from a file the user can write */
+	if (port == 0 || port != locate_card()) {
+		errno = ENXIO;
+		return -1;
+	}
+
+	radioport = port;
+	return 0;
+}
+
 void
 mute_sf64pcr(int v) {
 	u_int16_t value = v ? 0xf802 : 0xf800;
 
 	OUTW(radioport, value);
-	usleep(6);
+	delay_usec(6);
 	OUTW(radioport, value);
 }
 
@@ -138,33 +177,16 @@ mono_sf64pcr(void) {
 	card.stereo = TEA5757_MONO;
 }
 
-static void
-send_zero(void) {
-	OUTW(radioport, 0xf800);
-	OUTW(radioport, 0xf801);
-	OUTW(radioport, 0xf800);
-}
-
-static void
-send_one(void) {
-	OUTW(radioport, 0xf804);
-	OUTW(radioport, 0xf805);
-	OUTW(radioport, 0xf804);
-}
-
 static void
 write_shift_register(u_int32_t data) {
-	int c = 25;
+	struct bitbang_wave_t *w;
 
-	OUTW(radioport, 0xf800);
-
-	while (c--)
-		if (data & (1 << c))
-			send_one();
-		else
-			send_zero();
-
-	OUTW(radioport, 0xf802);
+	if (bitbang_lookup(&bb, data, &w) == 0) {
+		bitbang_put(w, 0xf800);
+		bitbang_encode(&bb, w, data, 25);
+		bitbang_put(w, 0xf802);
+	}
+	bitbang_emit(&bb, radioport, w);
 }
 
 static u_int32_t
@@ -173,23 +195,23 @@ read_shift_register(void) {
 	int rb, ind = 0;
 
 	OUTW(radioport, 0xfc02);
-	usleep(4); 
+	delay_usec(4);
 
 	/* Read the register */
 	rb = 23;
 	while (rb--) {
 		OUTW(radioport, 0xfc03);
-		usleep(4);			
+		delay_usec(4);
 
 		OUTW(radioport, 0xfc02);
-		usleep(4);
+		delay_usec(4);
 
 		res |= inw(radioport) & 0x04 ? 1 : 0;
 		res <<= 1;
 	}
 
 	OUTW(radioport, 0xfc03);
-	usleep(4);			
+	delay_usec(4);
 
 	rb = inw(radioport);
 	ind = rb & 0x08 ? 0 : DRV_INFO_SIGNAL; /* Tuning */
@@ -208,18 +230,10 @@ find_card_sf64pcr(void) {
 	u_int16_t cur_freq, test_freq = 0ul;
 	int err = -1;
 
-	struct pci_dev_t pd = {
-		PCI_VENDOR_ID_FORTEMEDIA, PCI_DEVICE_ID_FORTEMEDIA_FM801,
-		PCI_SUBSYS_ID_ANY, PCI_SUBSYS_ID_ANY, PCI_SUBCLASS_ANY,
-		PCI_REVISION_ANY
-	};
-
-	radioport = pci_bus_locate(&pd);
-	if (radioport == 0) {
+	if ((radioport = locate_card()) == 0) {
 		errno = ENXIO;
 		return -1;
 	}
-	radioport += 0x52;
 
 	/* Save old value */
 	cur_freq = get_frequency_sf64pcr();
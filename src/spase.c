@@ -44,6 +44,7 @@
 
 #include "ostypes.h"
 
+#include "delay.h"
 #include "radio_drv.h"
 
 typedef signed char i2cdata_t[8];
@@ -53,6 +54,13 @@ i2cdata_t  fmif, synth, sounda;
 #define FMIF_WRITE_ADDRESS 0xC2
 #define FMIF_READ_ADDRESS  0xC3
 
+/*
+ * Microseconds each I2C line level is held. The sound chip is a
+ * standard mode (100 kHz) part, the synth and fmif work at bus speed.
+ */
+#define SPASE_SOUND_DELAY  5
+#define SPASE_SYNTH_DELAY  0
+
 #define FALSE 0
 #define TRUE  1
 
@@ -64,7 +72,7 @@ i2cdata_t  fmif, synth, sounda;
 
 #define SPASE_CAPS		DRV_INFO_VOLUME(63) | DRV_INFO_MAXVOL_POLICY | \
 				DRV_INFO_VOL_SEPARATE | DRV_INFO_NEEDS_ROOT | \
-				DRV_INFO_MONOSTEREO
+				DRV_INFO_MONOSTEREO | DRV_INFO_GETS_LEVEL
 
 int grab_port_spase(u_int32_t);
 int release_port_spase(void);
@@ -73,6 +81,7 @@ int find_card_spase(void);
 void set_freq_spase(u_int16_t);
 void set_vol_spase(int);
 int state_spase(void);
+int level_spase(void);
 void mono_spase(void);
 
 u_int32_t sp_ports[] = { 0x1b0, 0x1f0, 0x278, 0x378, 0x2f8, 0x3bc };
@@ -81,10 +90,11 @@ struct tuner_drv_t sp_drv = {
 	"Spase PC-Radio", "sp", sp_ports, 6, SPASE_CAPS,
 	grab_port_spase, release_port_spase, info_port_spase,
 	find_card_spase, set_freq_spase, NULL, NULL, set_vol_spase,
-	NULL, mono_spase, NULL
+	NULL, mono_spase, NULL, level_spase
 };
 
 u_int32_t io;
+static u_int32_t i2c_delay = SPASE_SOUND_DELAY;
 
 struct tuner_drv_t *
 export_sp(void) {
@@ -95,11 +105,8 @@ export_sp(void) {
 
 void
 outport(u_int8_t value){
-	int i = 10000;
 	OUTB(io, value);
-	while (i--)			   /* It's a REALLY slow card ... */
-		;
-	/* Note: synth chip works without delay; needed by sound chip! */
+	delay_usec(i2c_delay);
 }
 
 int
@@ -193,6 +200,8 @@ I2C_packet(i2cdata_t *data, int NrOfBytes, int swap) {
 
 	error = FALSE;
 	WriteMode = ((*data[byte_i] & 1) == 0);
+	i2c_delay = (u_int8_t)(*data)[0] == SOUND_ADDRESS ?
+		SPASE_SOUND_DELAY : SPASE_SYNTH_DELAY;
 	I2C_start();
 	I2C_sendbyte((*data)[0]);
 	error |= I2C_readack();
@@ -289,13 +298,14 @@ GetTuningInfo(char * Level, char * Stereo, int * Deviation) {
 	if (Level)
 		*Level = (fmif[1] & 0x0F) >> 1;		/* 0..7     */
 	if (Deviation)
-		*Deviation = (fmif[2] - 127) / 2 ;	/* -64..+64 */
+		*Deviation = ((u_int8_t)fmif[2] - 127) / 2;	/* -64..+64 */
 	return error;
 }
 
 /* returns 0:card not found, 1:found */
 int
 CheckAddress(void) {
+	i2c_delay = SPASE_SOUND_DELAY;
 	outport(0);
 	outport(1);
 	outport(0);
@@ -409,3 +419,13 @@ state_spase(void) {
 	GetTuningInfo(&l, &s, &d);
 	return 0;
 }
+
+int
+level_spase(void) {
+	char l;
+
+	if (GetTuningInfo(&l, NULL, NULL))
+		return 0;
+
+	return l * DRV_INFO_MAX_LEVEL / 7;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * sequential probability ratio test over station samples
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ostypes.h"
+
+#include "sprt.h"
+
+static struct sprt_stat_t counters;
+
+/*
+ * conf is "p0,p1,alpha,beta[,max]", NULL or empty for the defaults.
+ * max defaults to the given one.
+ * Returns -1 on malformed or out of range parameters.
+ */
+int
+sprt_init(struct sprt_t *s, const char *conf, u_int32_t max) {
+	double p0 = SPRT_DEF_P0, p1 = SPRT_DEF_P1;
+	double alpha = SPRT_DEF_ALPHA, beta = SPRT_DEF_BETA;
+	unsigned long m = max;
+
+	if (conf != NULL && *conf != '\0')
+		if (sscanf(conf, "%lf,%lf,%lf,%lf,%lu",
+		    &p0, &p1, &alpha, &beta, &m) < 4)
+			return -1;
+
+	if (p0 <= 0 || p0 >= p1 || p1 >= 1)
+		return -1;
+	if (alpha <= 0 || beta <= 0 || alpha + beta >= 1)
+		return -1;
+	if (m == 0)
+		return -1;
+
+	s->hit = log(p1 / p0);
+	s->miss = log((1 - p1) / (1 - p0));
+	s->accept = log((1 - beta) / alpha);
+	s->reject = log(beta / (1 - alpha));
+	s->max = m;
+
+	return 0;
+}
+
+void
+sprt_start(struct sprt_run_t *r) {
+	memset(r, 0, sizeof(*r));
+}
+
+/*
+ * Add a sample, returns SPRT_CONTINUE until the run is decided
+ */
+int
+sprt_step(struct sprt_t *s, struct sprt_run_t *r, int hit) {
+	int decision;
+
+	r->n++;
+	if (hit) {
+		r->hits++;
+		r->llr += s->hit;
+	} else
+		r->llr += s->miss;
+
+	if (r->llr >= s->accept)
+		decision = SPRT_ACCEPT;
+	else if (r->llr <= s->reject)
+		decision = SPRT_REJECT;
+	else if (r->n >= s->max) {
+		decision = r->llr > 0 ? SPRT_ACCEPT : SPRT_REJECT;
+		counters.truncated++;
+	} else
+		return SPRT_CONTINUE;
+
+	counters.runs++;
+	counters.samples += r->n;
+	if (decision == SPRT_ACCEPT)
+		counters.accepts++;
+	else
+		counters.rejects++;
+
+	return decision;
+}
+
+void
+sprt_stat(struct sprt_stat_t *s) {
+	memcpy(s, &counters, sizeof(counters));
+}
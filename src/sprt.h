@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * sequential probability ratio test over station samples
+ *
+ * Each sample is a hit or a miss, i.e. the card reported some signal
+ * or none.  Wald's SPRT weighs the hypothesis that a station is there,
+ * hits coming with probability p1, against an empty channel with
+ * probability p0, and stops sampling as soon as either is accepted
+ * with the error rates alpha and beta.  A run not settled after max
+ * samples is decided by the sign of its log-likelihood ratio.
+ */
+
+#ifndef SPRT_H__
+#define SPRT_H__
+
+#define SPRT_REJECT	-1
+#define SPRT_CONTINUE	0
+#define SPRT_ACCEPT	1
+
+#define SPRT_DEF_P0	0.1
+#define SPRT_DEF_P1	0.9
+#define SPRT_DEF_ALPHA	0.05
+#define SPRT_DEF_BETA	0.05
+
+struct sprt_t {
+	double hit;		/* Log-likelihood ratio step for a hit */
+	double miss;		/* and for a miss */
+	double accept;		/* Wald's thresholds */
+	double reject;
+	u_int32_t max;		/* Samples before deciding anyway */
+};
+
+struct sprt_run_t {
+	double llr;
+	u_int32_t n;		/* Samples taken */
+	u_int32_t hits;
+};
+
+struct sprt_stat_t {
+	u_int32_t runs;
+	u_int32_t samples;
+	u_int32_t accepts;
+	u_int32_t rejects;
+	u_int32_t truncated;	/* Decided at max samples */
+};
+
+int sprt_init(struct sprt_t *, const char *, u_int32_t);
+void sprt_start(struct sprt_run_t *);
+int sprt_step(struct sprt_t *, struct sprt_run_t *, int);
+void sprt_stat(struct sprt_stat_t *);
+
+#endif /* SPRT_H__ */
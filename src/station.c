@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * index of known stations
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ostypes.h"
+
+#include "station.h"
+
+static struct station_t stations[STATION_MAX];
+static int count = 0;
+static int dirty = 0;
+
+static int lower_bound(u_int16_t);
+
+/*
+ * Missing file is an empty index.  Returns -1 on read errors.
+ */
+int
+station_load(const char *path) {
+	char line[STATION_LINELEN];
+	unsigned int strength, misses;
+	double mhz;
+	FILE *f;
+	int i;
+
+	count = dirty = 0;
+	if (path == NULL)
+		return 0;
+
+	if ((f = fopen(path, "r")) == NULL)
+		return errno == ENOENT ? 0 : -1;
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (*line == '#')
+			continue;
+		strength = misses = 0;
+		if (sscanf(line, "%lf %u %u", &mhz, &strength, &misses) < 1)
+			continue;
+		if (station_add((u_int16_t)(mhz * 100 + 0.5), strength) < 0)
+			continue;
+		i = lower_bound((u_int16_t)(mhz * 100 + 0.5));
+		stations[i].misses = misses;
+	}
+
+	if (ferror(f)) {
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+	dirty = 0;
+
+	return 0;
+}
+
+int
+station_save(const char *path) {
+	FILE *f;
+	int i;
+
+	if (path == NULL || (f = fopen(path, "w")) == NULL)
+		return -1;
+
+	fprintf(f, "# fmio station index: MHz, strength, misses\n");
+	for (i = 0; i < count; i++)
+		fprintf(f, "%u.%02u %u %u\n", stations[i].freq / 100,
+		    stations[i].freq % 100, stations[i].strength,
+		    stations[i].misses);
+
+	if (fclose(f) == EOF)
+		return -1;
+	dirty = 0;
+
+	return 0;
+}
+
+int
+station_dirty(void) {
+	return dirty;
+}
+
+int
+station_count(void) {
+	return count;
+}
+
+/*
+ * Replaces the strength of a station already known
+ */
+int
+station_add(u_int16_t freq, u_int16_t strength) {
+	int i = lower_bound(freq);
+
+	if (i < count && stations[i].freq == freq) {
+		stations[i].strength = strength;
+		stations[i].misses = 0;
+		dirty = 1;
+		return 0;
+	}
+	if (count == STATION_MAX)
+		return -1;
+
+	memmove(&stations[i + 1], &stations[i],
+	    (count - i) * sizeof(struct station_t));
+	stations[i].freq = freq;
+	stations[i].strength = strength;
+	stations[i].misses = 0;
+	count++;
+	dirty = 1;
+
+	return 0;
+}
+
+int
+station_del(u_int16_t freq) {
+	int i = lower_bound(freq);
+
+	if (i == count || stations[i].freq != freq)
+		return -1;
+
+	memmove(&stations[i], &stations[i + 1],
+	    (count - i - 1) * sizeof(struct station_t));
+	count--;
+	dirty = 1;
+
+	return 0;
+}
+
+/*
+ * A station passed its check
+ */
+int
+station_hit(u_int16_t freq) {
+	int i = lower_bound(freq);
+
+	if (i == count || stations[i].freq != freq)
+		return -1;
+
+	if (stations[i].misses != 0) {
+		stations[i].misses = 0;
+		dirty = 1;
+	}
+
+	return 0;
+}
+
+/*
+ * A station failed its check, it is dropped after STATION_MISSES
+ * in a row.  Returns 1 if it was dropped.
+ */
+int
+station_miss(u_int16_t freq) {
+	int i = lower_bound(freq);
+
+	if (i == count || stations[i].freq != freq)
+		return -1;
+
+	dirty = 1;
+	if (++stations[i].misses < STATION_MISSES)
+		return 0;
+
+	station_del(freq);
+	return 1;
+}
+
+/*
+ * Forget stations in [s, e), before they are scanned again
+ */
+void
+station_clear(u_int16_t s, u_int16_t e) {
+	int i = lower_bound(s), j = lower_bound(e);
+
+	if (i == j)
+		return;
+
+	memmove(&stations[i], &stations[j],
+	    (count - j) * sizeof(struct station_t));
+	count -= j - i;
+	dirty = 1;
+}
+
+/*
+ * Nearest station above freq, or below it if dir is 0.
+ * Returns -1 if there is none.
+ */
+int
+station_find(int dir, u_int16_t freq, u_int16_t *found) {
+	int i;
+
+	if (dir) {
+		i = lower_bound(freq + 1);
+		if (i == count)
+			return -1;
+	} else {
+		i = lower_bound(freq) - 1;
+		if (i < 0)
+			return -1;
+	}
+
+	*found = stations[i].freq;
+	return 0;
+}
+
+/*
+ * Index of the first station at or above freq
+ */
+static int
+lower_bound(u_int16_t freq) {
+	int lo = 0, hi = count, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (stations[mid].freq < freq)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
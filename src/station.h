@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * index of known stations
+ *
+ * Stations found by scans are kept sorted by frequency, so seeking
+ * finds the next one up or down by binary search.  The index is saved
+ * as text, a line per station with the frequency in MHz and its
+ * strength, the summed card state per 100 probes.
+ */
+
+#ifndef STATION_H__
+#define STATION_H__
+
+#define STATION_MAX	256
+#define STATION_LINELEN	64
+#define STATION_MISSES	3	/* Failed checks before a station is dropped */
+
+struct station_t {
+	u_int16_t freq;		/* 10 kHz */
+	u_int16_t strength;
+	u_int16_t misses;	/* Failed checks in a row */
+};
+
+int station_load(const char *);
+int station_save(const char *);
+int station_dirty(void);
+int station_count(void);
+int station_add(u_int16_t, u_int16_t);
+int station_del(u_int16_t);
+int station_hit(u_int16_t);
+int station_miss(u_int16_t);
+void station_clear(u_int16_t, u_int16_t);
+int station_find(int, u_int16_t, u_int16_t *);
+
+#endif /* STATION_H__ */
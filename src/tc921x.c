@@ -53,6 +53,7 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "radio_drv.h"
 #include "tc921x.h"
 
@@ -66,43 +67,30 @@
 #define WR_PH_CH_DL(port, p, c, d)	OUTB(port, p * 1 | c * 1 | d * 0)
 #define WR_PH_CH_DH(port, p, c, d)	OUTB(port, p * 1 | c * 1 | d * 1)
 
-static void __tc921x_write_burst(u_int8_t, u_int32_t, struct tc921x_t *, int);
+static void __tc921x_bitbang(struct bitbang_t *, struct tc921x_t *, int);
+static void __tc921x_write_head(struct bitbang_wave_t *, u_int8_t, struct tc921x_t *);
 static u_int32_t __tc921x_read_burst(u_int8_t, struct tc921x_t *);
 
 u_int16_t
 tc921x_encode_freq(u_int16_t freq) {
-	u_int16_t ret;
-
-	ret = freq + 1070;
-
-	return ret;
+	return TC921X_ENCODE_FREQ(freq);
 }
 
 u_int16_t
 tc921x_decode_freq(u_int16_t reg) {
-	u_int16_t freq;
-
-	freq = (reg & TC921X_D0_FREQ_DIVIDER) - 1070;
-
-	return freq;
+	return TC921X_DECODE_FREQ(reg);
 }
 
 u_int32_t
 tc921x_read_addr(struct tc921x_t *c, u_int8_t addr) {
+	struct bitbang_t bb;
+	struct bitbang_wave_t w;
 	u_int32_t ret;
 
-	/* Finish previous transmission - PERIOD HIGH, CLOCK HIGH, DATA HIGH */
-	WR_PH_CH_DH(c->port, c->period, c->clock, c->data);
-	/* Start transmission - PERIOD LOW, CLOCK HIGH, DATA HIGH */
-	WR_PL_CH_DH(c->port, c->period, c->clock, c->data);
-
-	/*
-	 * Period must be low when the register address transmission starts.
-	 * Period must be high when the register data transmission starts.
-	 * Do the switch in the middle of the address transmission.
-	 */
-	__tc921x_write_burst(4, addr, c, 0);
-	__tc921x_write_burst(4, addr >> 4, c, 1);
+	bitbang_clear(&w);
+	__tc921x_write_head(&w, addr, c);
+	__tc921x_bitbang(&bb, c, 1);
+	bitbang_emit(&bb, c->port, &w);
 
 	/* Reading data from the register */
 	ret = __tc921x_read_burst(TC921X_REGISTER_LENGTH, c);
@@ -116,40 +104,60 @@ tc921x_read_addr(struct tc921x_t *c, u_int8_t addr) {
 
 void
 tc921x_write_addr(struct tc921x_t *c, u_int8_t addr, u_int32_t reg) {
+	struct bitbang_t bb;
+	struct bitbang_wave_t *w;
+
+	__tc921x_bitbang(&bb, c, 1);
+
+	if (bitbang_lookup(c, (u_int32_t)addr << TC921X_REGISTER_LENGTH |
+	    (reg & ((1ul << TC921X_REGISTER_LENGTH) - 1)), &w) == 0) {
+		__tc921x_write_head(w, addr, c);
+		/* Writing data to the register */
+		bitbang_encode(&bb, w, reg, TC921X_REGISTER_LENGTH);
+		/* End of transmission - PERIOD goes LOW then HIGH */
+		bitbang_put(w, c->clock | c->data);
+		bitbang_put(w, c->period | c->clock | c->data);
+	}
+	bitbang_emit(&bb, c->port, w);
+}
+
+/*
+ * Bit phases: CLOCK goes LOW then HIGH with DATA set,
+ * PERIOD is kept HIGH if p is non-zero
+ */
+static void
+__tc921x_bitbang(struct bitbang_t *bb, struct tc921x_t *c, int p) {
+	u_int16_t period = p ? c->period : 0;
+
+	bb->wide = 0;
+	bb->order = BITBANG_LSB_FIRST;
+	bb->phases = 2;
+	bb->zero[0] = period;
+	bb->zero[1] = period | c->clock;
+	bb->one[0] = period | c->data;
+	bb->one[1] = period | c->clock | c->data;
+	bb->hold = 0;
+	bb->reads = 0;
+}
+
+static void
+__tc921x_write_head(struct bitbang_wave_t *w, u_int8_t addr, struct tc921x_t *c) {
+	struct bitbang_t bb;
+
 	/* Finish previous transmission - PERIOD HIGH, CLOCK HIGH, DATA HIGH */
-	WR_PH_CH_DH(c->port, c->period, c->clock, c->data);
+	bitbang_put(w, c->period | c->clock | c->data);
 	/* Start transmission - PERIOD LOW, CLOCK HIGH, DATA HIGH */
-	WR_PL_CH_DH(c->port, c->period, c->clock, c->data);
+	bitbang_put(w, c->clock | c->data);
 
 	/*
 	 * Period must be low when the register address transmission starts.
 	 * Period must be high when the register data transmission starts.
 	 * Do the switch in the middle of the address transmission.
 	 */
-	__tc921x_write_burst(4, addr, c, 0);
-	__tc921x_write_burst(4, addr >> 4, c, 1);
-
-	/* Writing data to the register */
-	__tc921x_write_burst(TC921X_REGISTER_LENGTH, reg, c, 1);
-
-	/* End of transmission - PERIOD goes LOW then HIGH */
-	WR_PL_CH_DH(c->port, c->period, c->clock, c->data);
-	WR_PH_CH_DH(c->port, c->period, c->clock, c->data);
-}
-
-static void
-__tc921x_write_burst(u_int8_t length, u_int32_t data, struct tc921x_t *c, int p) {
-	u_int8_t i;
-
-	for (i = 0; i < length; i++) {
-		if (data & (1 << i)) {
-			WR_PH_CL_DH(c->port, c->period * p, c->clock, c->data);
-			WR_PH_CH_DH(c->port, c->period * p, c->clock, c->data);
-		} else {
-			WR_PH_CL_DL(c->port, c->period * p, c->clock, c->data);
-			WR_PH_CH_DL(c->port, c->period * p, c->clock, c->data);
-		}
-	}
+	__tc921x_bitbang(&bb, c, 0);
+	bitbang_encode(&bb, w, addr, 4);
+	__tc921x_bitbang(&bb, c, 1);
+	bitbang_encode(&bb, w, addr >> 4, 4);
 }
 
 static u_int32_t
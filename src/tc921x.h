@@ -39,6 +39,11 @@
 
 #define TC921X_REGISTER_LENGTH	24
 
+#define TC921X_IF		1070	/* 10.7 MHz */
+#define TC921X_ENCODE_FREQ(f)	((u_int16_t)((f) + TC921X_IF))
+#define TC921X_DECODE_FREQ(r)	\
+	((u_int16_t)(((r) & TC921X_D0_FREQ_DIVIDER) - TC921X_IF))
+
 /* Register at address 0xD0 */
 #define TC921X_D0_FREQ_DIVIDER			0xFFFF
 
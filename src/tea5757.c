@@ -30,17 +30,22 @@
 
 #include "ostypes.h"
 
+#include "freqtab.h"
+#include "radio.h"
 #include "radio_drv.h"
 #include "tea5757.h"
 
-void
+/*
+ * Returns 0 if the chip already holds the register and nothing was sent
+ */
+int
 tea5757_write_shift_register(struct tea5757_t *card) {
 	u_int32_t reg = 0ul;
 
 	if (card->frequency) {
-		reg = card->frequency;
-		reg += 1070;
-		reg /= 1.25;
+		reg = FREQTAB_IN(card->frequency) ?
+		    freqtab_tea5757[FREQTAB_IDX(card->frequency)] :
+		    TEA5757_ENCODE_FREQ(card->frequency);
 	} else {
 		reg = TEA5757_SEARCH_START | card->search;
 	}
@@ -48,56 +53,126 @@ tea5757_write_shift_register(struct tea5757_t *card) {
 	reg |= card->stereo;
 	reg |= card->sensitivity;
 
+	if (card->valid && reg == card->shadow)
+		return 0;
+
 	card->write(reg);
+	card->written = 1;
+
+	/* Search leaves the chip on another frequency */
+	card->shadow = reg;
+	card->valid = card->frequency != 0;
 
-	return;
+	return 1;
 }
 
+/*
+ * Forget the shadow register, e.g. if the chip
+ * was reset or retuned behind our back
+ */
+void
+tea5757_invalidate(struct tea5757_t *card) {
+	card->valid = 0;
+}
+
+/*
+ * Cards reporting the signal are polled with growing delays until it
+ * shows up or TEA5757_ACQUISITION_DELAY has passed, the others always
+ * wait the whole delay.  Right after a write the signal bit may still
+ * belong to the previous channel, so it is not read before
+ * TEA5757_SETTLE_DELAY.
+ */
 u_int32_t
 tea5757_read_shift_register(struct tea5757_t *card) {
-	u_int32_t reg;
+	u_int32_t reg, waited = 0, delay = TEA5757_WAIT_DELAY;
+
+	if (card->lock == 0) {
+		usleep(TEA5757_ACQUISITION_DELAY);
+		return card->read();
+	}
+
+	if (card->written) {
+		usleep(TEA5757_SETTLE_DELAY);
+		waited = TEA5757_SETTLE_DELAY;
+		card->written = 0;
+	}
 
-	usleep(TEA5757_ACQUISITION_DELAY);
-	reg = card->read();
+	while (((reg = card->read()) & card->lock) == 0 &&
+	    waited < TEA5757_ACQUISITION_DELAY) {
+		if (delay > TEA5757_ACQUISITION_DELAY - waited)
+			delay = TEA5757_ACQUISITION_DELAY - waited;
+		usleep(delay);
+		waited += delay;
+		delay *= 2;
+	}
 
 	return reg;
 }
 
+/*
+ * Found frequency, DRV_SEARCH_TIMEOUT if the deadline passed
+ */
 u_int32_t
 tea5757_search(struct tea5757_t *card) {
-	u_int32_t tmp = card->search;
-	unsigned int co = 0;
+	struct tea5757_seek_t res;
 
-	card->search = TEA5757_SEARCH_END;
-	tea5757_write_shift_register(card);
+	if (tea5757_seek(card, TEA5757_SEARCH_DEADLINE, &res) == 0)
+		return DRV_SEARCH_TIMEOUT;
 
-	usleep(TEA5757_ACQUISITION_DELAY);
-	card->frequency = 0;
-	card->search = tmp;
-	tmp = card->frequency;
-	tea5757_write_shift_register(card);
+	return res.frequency;
+}
 
-	card->frequency = tmp;
+/*
+ * Search from card->frequency in card->search direction, polling
+ * with growing delays until the chip stops or deadline microseconds
+ * pass. On timeout the search is stopped and the card is retuned back.
+ * Returns 1 if a station was found.
+ */
+int
+tea5757_seek(struct tea5757_t *card, u_int32_t deadline,
+    struct tea5757_seek_t *res) {
+	u_int32_t tmp, dir = card->search, from = card->frequency;
+	u_int32_t delay = TEA5757_WAIT_DELAY;
 
-	do {
-		usleep(TEA5757_WAIT_DELAY);
-		tmp = card->read(); 
-	} while ((tmp & TEA5757_FREQ) == 0 && ++co < 200);
+	card->search = TEA5757_SEARCH_END;
+	if (tea5757_write_shift_register(card))
+		usleep(TEA5757_ACQUISITION_DELAY);
+	card->frequency = 0;
+	card->search = dir;
+	tea5757_write_shift_register(card);
 
-	if (co > 199) {
-		card->search = TEA5757_SEARCH_END;
-		tea5757_write_shift_register(card);
+	card->frequency = from;
+
+	res->found = 0;
+	res->frequency = from;
+	res->elapsed = 0;
+	res->polls = 0;
+
+	while (res->elapsed < deadline) {
+		if (delay > deadline - res->elapsed)
+			delay = deadline - res->elapsed;
+		usleep(delay);
+		res->elapsed += delay;
+		if (delay < TEA5757_POLL_DELAY_MAX)
+			delay *= 2;
+
+		res->polls++;
+		tmp = card->read();
+		if (tmp & TEA5757_FREQ) {
+			res->found = 1;
+			res->frequency = tea5757_decode_frequency(tmp);
+			return 1;
+		}
 	}
 
-	return co < 200 ? tea5757_decode_frequency(tmp) : card->frequency;
+	/* Back where the search started */
+	card->search = TEA5757_SEARCH_END;
+	tea5757_write_shift_register(card);
+
+	return 0;
 }
 
 u_int32_t
 tea5757_decode_frequency(u_int32_t data) {
-	u_int32_t freq = data & TEA5757_FREQ;
-
-	freq *= 1.25;
-	freq -= 1070;
-
-	return freq;
+	return TEA5757_DECODE_FREQ(data);
 }
@@ -32,6 +32,15 @@
 #define TEA5757_FREQ		0x0007FFF
 #define TEA5757_DATA		0x1FF8000
 
+/*
+ * The register counts 12.5 kHz steps above the IF.
+ * Decoding rounds up, so that the result encodes to the same register.
+ */
+#define TEA5757_IF		1070	/* 10.7 MHz */
+#define TEA5757_ENCODE_FREQ(f)	(((u_int32_t)(f) + TEA5757_IF) * 4 / 5)
+#define TEA5757_DECODE_FREQ(r)	\
+	((((u_int32_t)(r) & TEA5757_FREQ) * 5 + 3) / 4 - TEA5757_IF)
+
 #define TEA5757_SEARCH_START		(1<<24) /* 0x1000000 */
 #define TEA5757_SEARCH_END		(0<<24) /* 0x0000000 */
 
@@ -40,6 +49,9 @@
 #define TEA5757_SEARCH_DELAY		14	/* 14 microseconds */
 #define TEA5757_WAIT_DELAY		1000
 #define TEA5757_ACQUISITION_DELAY	100000
+#define TEA5757_SETTLE_DELAY		20000	/* Signal bit after a write */
+#define TEA5757_SEARCH_DEADLINE		200000
+#define TEA5757_POLL_DELAY_MAX		8000
 
 #define TEA5757_STEREO		(0<<22) /* 0x0000000 */
 #define TEA5757_MONO		(1<<22) /* 0x0400000 */
@@ -64,11 +76,24 @@ struct tea5757_t {
 	int stereo;
 	u_int32_t (*read)(void);
 	void (*write)(u_int32_t);
+	u_int32_t lock;		/* Signal bit in read(), 0 - none */
+	int written;		/* Written since the last read */
+	u_int32_t shadow;	/* Last register written */
+	int valid;		/* The chip holds shadow */
+};
+
+struct tea5757_seek_t {
+	int found;		/* 0 - deadline passed */
+	u_int32_t frequency;	/* Found, or the one searched from */
+	u_int32_t elapsed;	/* Microseconds waited for the chip */
+	u_int32_t polls;	/* Reads of the shift register */
 };
 
 u_int32_t tea5757_decode_frequency(u_int32_t);
-void tea5757_write_shift_register(struct tea5757_t *);
+int tea5757_write_shift_register(struct tea5757_t *);
+void tea5757_invalidate(struct tea5757_t *);
 u_int32_t tea5757_read_shift_register(struct tea5757_t *);
 u_int32_t tea5757_search(struct tea5757_t *);
+int tea5757_seek(struct tea5757_t *, u_int32_t, struct tea5757_seek_t *);
 
 #endif /* TEA5757_H__ */
@@ -37,6 +37,7 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
 #include "radio_drv.h"
 #include "tea5757.h"
 
@@ -74,6 +75,10 @@ static struct tea5757_t card = {
 	read_shift_register, write_shift_register
 };
 
+static struct bitbang_t bb = {
+	0, BITBANG_MSB_FIRST, 3, { 0 }, { 0 }, 0, 0
+};
+
 /******************************************************************/
 
 struct tuner_drv_t *
@@ -83,6 +88,12 @@ export_tt(void) {
 
 int
 get_port_tt(u_int32_t port) {
+	tea5757_invalidate(&card);
+	bitbang_flush(&bb);
+	bb.zero[0] = bb.zero[2] = TEA_wren;
+	bb.zero[1] = TEA_wren | TEA_clk;
+	bb.one[0] = bb.one[2] = TEA_wren | TEA_data;
+	bb.one[1] = TEA_wren | TEA_clk | TEA_data;
 	return radio_get_iopl() < 0 ? -1 : 0;
 }
 
@@ -152,19 +163,12 @@ read_shift_register(void) {
 
 static void
 write_shift_register(u_int32_t data) {
-    int c = 25;
-
-	OUTB(*tt_port, TEA_wren);
-
-	while (c--)
-		if (data & (1 << c)) {
-			OUTB(*tt_port, TEA_wren | TEA_data);
-			OUTB(*tt_port, TEA_wren | TEA_clk | TEA_data);
-			OUTB(*tt_port, TEA_wren | TEA_data);
-		} else {
-			OUTB(*tt_port, TEA_wren);
-			OUTB(*tt_port, TEA_wren | TEA_clk);
-			OUTB(*tt_port, TEA_wren);
-		}
-	OUTB(*tt_port, 0);
+	struct bitbang_wave_t *w;
+
+	if (bitbang_lookup(&bb, data, &w) == 0) {
+		bitbang_put(w, TEA_wren);
+		bitbang_encode(&bb, w, data, 25);
+		bitbang_put(w, 0);
+	}
+	bitbang_emit(&bb, *tt_port, w);
 }
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2002 Vladimir Popov <jumbo@narod.ru>.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * $Id$
+ * microsecond timer for tracing and benchmarks
+ *
+ * Monotonic where the OS has it. On DOS the resolution is that of
+ * clock(), i.e. one BIOS tick.
+ */
+
+#include <time.h>
+#ifndef __DOS__
+#include <sys/time.h>
+#endif /* !__DOS__ */
+
+#include "ostypes.h"
+#include "timer.h"
+
+u_int64_t
+timer_usec(void) {
+#ifdef __DOS__
+	return (u_int64_t)clock() * 1000000 / CLOCKS_PER_SEC;
+#else
+	struct timeval tv;
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+		return (u_int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif /* CLOCK_MONOTONIC */
+
+	gettimeofday(&tv, NULL);
+
+	return (u_int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif /* __DOS__ */
+}
@@ -45,7 +45,8 @@
 
 #define XTREME_CAPS		DRV_INFO_HARDW_SRCH | DRV_INFO_MONOSTEREO | \
 				DRV_INFO_GETS_SIGNAL | DRV_INFO_GETS_STEREO | \
-				DRV_INFO_VOLUME(1) | DRV_INFO_VOL_SEPARATE
+				DRV_INFO_VOLUME(1) | DRV_INFO_VOL_SEPARATE | \
+				DRV_INFO_GETS_LEVEL
 
 const char *set_data_err = "BT848_GPIO_SET_DATA";
 const char *set_en_err = "BT848_GPIO_SET_EN";
@@ -60,12 +61,13 @@ u_int16_t search_xtreme(int, u_int16_t);
 void mute_xtreme(int);
 void mono_xtreme(void);
 int state_xtreme(void);
+int level_xtreme(void);
 
 struct tuner_drv_t xtreme_drv = {
 	"AIMS Lab Highway Xtreme", "hx", NULL, 0, XTREME_CAPS,
 	get_port_xtreme, free_port_xtreme, NULL, find_card_xtreme,
 	set_freq_xtreme, NULL, search_xtreme, mute_xtreme, NULL,
-	mono_xtreme, state_xtreme
+	mono_xtreme, state_xtreme, level_xtreme
 };
 
 static void send_bit(int, int);
@@ -96,6 +98,7 @@ send_bit(int pos, int val) {
 
 int
 get_port_xtreme(u_int32_t radioport) {
+	tea5757_invalidate(&card);
 	fd = radio_device_get(tuner_device_1, tuner_device_2, O_RDONLY);
 	return fd < 0 ? -1 : 0;
 }
@@ -123,6 +126,10 @@ mute_xtreme(int v) {
 	gpio_data |= v ? 0x02 : 0x01;
 	if (ioctl(fd, BT848_GPIO_SET_DATA, &gpio_data) < 0)
 		warn(set_data_err);
+
+	/* Writing the shift register unmutes */
+	if (v == 0)
+		tea5757_invalidate(&card);
 }
 
 int
@@ -140,6 +147,15 @@ state_xtreme(void) {
 	return 0;
 }
 
+int
+level_xtreme(void) {
+	int ss;
+
+	if (ioctl(fd, TVTUNER_GETSTATUS, &ss) < 0) return 0;
+
+	return (ss & 0x07) * DRV_INFO_MAX_LEVEL / 7;
+}
+
 static void
 write_shift_register(u_int32_t reg) {
 	int i;
@@ -29,9 +29,13 @@
 
 #include "ostypes.h"
 
+#include "bitbang.h"
+#include "delay.h"
 #include "radio_drv.h"
 
-#define LWRITE(a)	usleep(0); OUTB(radioport, a)
+#define ZOLTRIX_WRITE_DELAY	1
+
+#define LWRITE(a)	delay_usec(ZOLTRIX_WRITE_DELAY);OUTB(radioport, a)
 
 #define ZOLTRIX_CAPS		DRV_INFO_NEEDS_ROOT | DRV_INFO_NEEDS_SCAN | \
 				DRV_INFO_MONOSTEREO | DRV_INFO_GETS_SIGNAL | \
@@ -59,6 +63,11 @@ static int stereo = 0; /* Use stereo by default */
 static int vol = 0;
 static u_int32_t radioport = 0;
 
+static struct bitbang_t bb = {
+	0, BITBANG_MSB_FIRST, 3, { 0xc0, 0x40, 0xc0 }, { 0x80, 0x00, 0x80 },
+	ZOLTRIX_WRITE_DELAY, 0
+};
+
 /******************************************************************/
 
 struct tuner_drv_t *
@@ -85,38 +94,33 @@ info_port_zoltrix(void) {
 void
 set_freq_zoltrix(u_int16_t frequency) {
 	/* tunes the radio to the desired frequency */
+	struct bitbang_wave_t *w;
 	unsigned long long bitmask, f;
-	int i;
 	float freq = frequency/100;
 
-	f = (unsigned long long)(((float)(freq-88.0))*200.0)+0x4d1c;
-	i = 45;
-	bitmask = 0xc480402c10080000ull;
-	bitmask = (bitmask^((f&0xff)<<47)^((f&0xff00)<<30)^(stereo<<31));
-
 	LWRITE(0x0);
 	LWRITE(0x0);
 	inb(radioport+3);
 
-	LWRITE(0x40);
-	LWRITE(0xc0);
-	while (i--) {
-		if ((bitmask & 0x8000000000000000ull) != 0) {
-			LWRITE(0x80);
-			LWRITE(0x00);
-			LWRITE(0x80);
-		} else {
-			LWRITE(0xc0);
-			LWRITE(0x40);
-			LWRITE(0xc0);
-		}
-		bitmask *= 2;
+	if (bitbang_lookup(&bb, frequency | stereo << 16, &w) == 0) {
+		f = (unsigned long long)(((float)(freq-88.0))*200.0)+0x4d1c;
+		bitmask = 0xc480402c10080000ull;
+		bitmask = (bitmask^((f&0xff)<<47)^((f&0xff00)<<30)^
+		    (stereo<<31));
+
+		/* 45 most significant bits of bitmask */
+		bitbang_put(w, 0x40);
+		bitbang_put(w, 0xc0);
+		bitbang_encode(&bb, w, (u_int32_t)(bitmask >> 32), 32);
+		bitbang_encode(&bb, w, (u_int32_t)(bitmask >> 19) & 0x1fff, 13);
+
+		/* Termination sequence */
+		bitbang_put(w, 0x80);
+		bitbang_put(w, 0xc0);
+		bitbang_put(w, 0x40);
 	}
+	bitbang_emit(&bb, radioport, w);
 
-	/* Termination sequence */
-	LWRITE(0x80);
-	LWRITE(0xc0);
-	LWRITE(0x40);
 	usleep(20000);
 	if (vol) { LWRITE(vol); }
 	usleep(10000);